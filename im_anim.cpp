@@ -7,8 +7,17 @@
 #include "imgui_internal.h"
 #include <stdio.h>
 #include <string.h>
+#include <atomic>
+#include <chrono>
 #ifdef _WIN32
 #include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IAM_PACK_HAS_MMAP
 #endif
 
 #ifdef IM_ANIM_PRE_19200_COMPATIBILITY
@@ -500,6 +509,40 @@ static ImGuiID make_key(ImGuiID id, ImGuiID ch) {
 // Forward declare global time for channels to use
 static double g_global_time = 0.0;
 
+// Time domains (iam_time_domain_create): extra clocks with their own scale and pause. Slot 0 is the default
+// domain (g_global_time); slot s > 0 is g_domains[s - 1]. Freed slots are reused and their clock resumes
+// from where it stopped, so channels still bound to a reused slot never see time jump backward.
+struct time_domain {
+	ImGuiID	id;			// 0 = free slot
+	double	time;		// Scaled clock
+	double	origin;		// time when created (iam_time_domain_time is relative to it)
+	float	scale;
+	bool	paused;
+};
+
+static ImVector<time_domain> g_domains;
+static ImGuiStorage g_domain_map;		// domain id -> slot
+static ImVector<int> g_domain_stack;	// iam_push_time_domain
+static int g_domain = 0;				// Current slot
+
+static double domain_time(int slot) {
+	return slot == 0 ? g_global_time : g_domains[slot - 1].time;
+}
+
+static bool domain_paused(int slot) {
+	return slot != 0 && g_domains[slot - 1].paused;
+}
+
+// Move a channel to the current domain, keeping its progress. Returns true if that domain is paused.
+template<typename C>
+static bool enter_domain(C* c) {
+	if (c->domain != g_domain) {
+		c->start_time += domain_time(g_domain) - domain_time(c->domain);
+		c->domain = g_domain;
+	}
+	return domain_paused(g_domain);
+}
+
 // Minimum duration to avoid division by zero
 static float const MIN_DURATION = 1e-6f;
 
@@ -549,6 +592,7 @@ struct base_chan {
 	unsigned last_seen_frame;
 	unsigned has_pending;
 	unsigned sleeping;
+	int		domain;  // Time domain slot
 	T		pending_target;
 
 	base_chan() {
@@ -564,13 +608,14 @@ struct base_chan {
 		last_seen_frame = 0;
 		has_pending = 0;
 		sleeping = 1;
+		domain = 0;
 	}
 
 	void set(T trg, float d, iam_ease_desc const& e, int pol) {
 		start = current;
 		target = trg;
 		dur = (d <= MIN_DURATION ? MIN_DURATION : d);
-		start_time = g_global_time;
+		start_time = domain_time(domain);
 		t = 0;
 		ez = e;
 		policy = pol;
@@ -579,7 +624,7 @@ struct base_chan {
 
 	float progress() {
 		if (sleeping) { t = 1.0f; return 1.0f; }
-		t = (float)((g_global_time - start_time) / dur);
+		t = (float)((domain_time(domain) - start_time) / dur);
 		if (t < 0.f) t = 0.f;
 		else if (t > 1.f) t = 1.f;
 		return t;
@@ -613,6 +658,7 @@ struct color_chan {
 	int		space;
 	unsigned last_seen_frame;
 	unsigned sleeping;
+	int		domain;  // Time domain slot
 
 	color_chan() {
 		current = ImVec4(1, 1, 1, 1);
@@ -626,13 +672,14 @@ struct color_chan {
 		space = iam_col_srgb_linear;
 		last_seen_frame = 0;
 		sleeping = 1;
+		domain = 0;
 	}
 
 	void set(ImVec4 trg, float d, iam_ease_desc const& e, int pol, int sp) {
 		start = current;
 		target = trg;
 		dur = (d <= MIN_DURATION ? MIN_DURATION : d);
-		start_time = g_global_time;
+		start_time = domain_time(domain);
 		t = 0;
 		ez = e;
 		policy = pol;
@@ -642,7 +689,7 @@ struct color_chan {
 
 	float progress() {
 		if (sleeping) { t = 1.0f; return 1.0f; }
-		t = (float)((g_global_time - start_time) / dur);
+		t = (float)((domain_time(domain) - start_time) / dur);
 		if (t < 0.f) t = 0.f;
 		else if (t > 1.f) t = 1.f;
 		return t;
@@ -690,12 +737,38 @@ static pool_t<color_chan> g_color;
 // Global time scale for slow-motion / fast-forward
 static float g_time_scale = 1.0f;
 
+// Time scale for dt-driven state (oscillators, shake, wiggle, noise channels) in the current time domain
+static float current_time_scale() {
+	return g_domain == 0 ? g_time_scale : g_time_scale * g_domains[g_domain - 1].scale;
+}
+
+static void advance_domains(float dt) {
+	for (int i = 0; i < g_domains.Size; ++i) {
+		time_domain& d = g_domains[i];
+		if (d.id != 0 && !d.paused) d.time += dt * g_time_scale * d.scale;
+	}
+}
+
 // Global frame counter for oscillators and procedural animations
 static unsigned g_frame = 0;
 
 // Lazy initialization - defer channel creation until animation is needed
 static bool g_lazy_init_enabled = true;
 
+// Tween culling (iam_set_tween_culling): calls made while the current window skips its items keep the last value
+static bool g_tween_culling = false;
+static int g_tweens_culled = 0;			// This frame
+static int g_tweens_culled_last = 0;	// Previous frame
+
+static bool tween_culled() {
+	if (!g_tween_culling) return false;
+	if (!ImGui::GetCurrentContext()) return false;
+	ImGuiWindow* window = ImGui::GetCurrentWindowRead();
+	if (!window || !window->SkipItems) return false;
+	g_tweens_culled++;
+	return true;
+}
+
 // Note: g_custom_ease is forward-declared earlier and initialized to nullptr here
 
 // ----------------------------------------------------
@@ -787,8 +860,11 @@ void iam_update_begin_frame() {
 	iam_detail::g_int.begin();
 	iam_detail::g_color.begin();
 	iam_detail::g_frame++;
+	iam_detail::g_tweens_culled_last = iam_detail::g_tweens_culled;
+	iam_detail::g_tweens_culled = 0;
 	// Accumulate global time (scaled)
 	iam_detail::g_global_time += ImGui::GetIO().DeltaTime * iam_detail::g_time_scale;
+	if (iam_detail::g_domains.Size > 0) iam_detail::advance_domains(ImGui::GetIO().DeltaTime);
 	iam_scroll_update_internal(ImGui::GetIO().DeltaTime);
 }
 
@@ -842,6 +918,18 @@ bool iam_is_lazy_init_enabled() {
 	return iam_detail::g_lazy_init_enabled;
 }
 
+void iam_set_tween_culling(bool enable) {
+	iam_detail::g_tween_culling = enable;
+}
+
+bool iam_get_tween_culling() {
+	return iam_detail::g_tween_culling;
+}
+
+int iam_get_tweens_culled() {
+	return iam_detail::g_tweens_culled_last;
+}
+
 // ----------------------------------------------------
 // Profiler API implementations
 // ----------------------------------------------------
@@ -947,14 +1035,18 @@ float iam_tween_float(ImGuiID id, ImGuiID channel_id, float target, float dur, i
 		c = g_float.get(key);
 		c->current = c->start = c->target = init_value;
 	}
+	// Time domain (iam_push_time_domain): a paused domain holds the value
+	if (enter_domain(c)) return c->current;
 
 	// Fast path: sleeping and target unchanged
 	if (c->sleeping && fabsf(c->target - target) <= 1e-6f && !c->has_pending) {
 		return c->current;
 	}
+	// Hidden window (iam_set_tween_culling): hold the last value, easing resumes on the next visible call
+	if (fabsf(c->target - target) <= 1e-6f && !c->has_pending && tween_culled()) return c->current;
 
 	// Compute current progress
-	float t_now = c->sleeping ? 1.0f : (float)((g_global_time - c->start_time) / c->dur);
+	float t_now = c->sleeping ? 1.0f : (float)((domain_time(c->domain) - c->start_time) / c->dur);
 	bool anim_complete = t_now >= 1.0f;
 
 	bool const change = (c->policy!=policy) || (c->ez.type!=ez.type) ||
@@ -991,12 +1083,15 @@ ImVec2 iam_tween_vec2(ImGuiID id, ImGuiID channel_id, ImVec2 target, float dur,
 		c = g_vec2.get(key);
 		c->current = c->start = c->target = init_value;
 	}
+	if (enter_domain(c)) return c->current;  // Paused time domain
 
 	if (c->sleeping && fabsf(c->target.x - target.x) + fabsf(c->target.y - target.y) <= 1e-6f && !c->has_pending) {
 		return c->current;
 	}
+	// Hidden window (iam_set_tween_culling): hold the last value, easing resumes on the next visible call
+	if (fabsf(c->target.x - target.x) + fabsf(c->target.y - target.y) <= 1e-6f && !c->has_pending && tween_culled()) return c->current;
 
-	float t_now = c->sleeping ? 1.0f : (float)((g_global_time - c->start_time) / c->dur);
+	float t_now = c->sleeping ? 1.0f : (float)((domain_time(c->domain) - c->start_time) / c->dur);
 	bool anim_complete = t_now >= 1.0f;
 
 	bool const change = (c->policy!=policy) || (c->ez.type!=ez.type) ||
@@ -1026,12 +1121,15 @@ ImVec4 iam_tween_vec4(ImGuiID id, ImGuiID channel_id, ImVec4 target, float dur,
 		c = g_vec4.get(key);
 		c->current = c->start = c->target = init_value;
 	}
+	if (enter_domain(c)) return c->current;  // Paused time domain
 
 	if (c->sleeping && fabsf(c->target.x-target.x)+fabsf(c->target.y-target.y)+fabsf(c->target.z-target.z)+fabsf(c->target.w-target.w) <= 1e-6f && !c->has_pending) {
 		return c->current;
 	}
+	// Hidden window (iam_set_tween_culling): hold the last value, easing resumes on the next visible call
+	if (fabsf(c->target.x-target.x)+fabsf(c->target.y-target.y)+fabsf(c->target.z-target.z)+fabsf(c->target.w-target.w) <= 1e-6f && !c->has_pending && tween_culled()) return c->current;
 
-	float t_now = c->sleeping ? 1.0f : (float)((g_global_time - c->start_time) / c->dur);
+	float t_now = c->sleeping ? 1.0f : (float)((domain_time(c->domain) - c->start_time) / c->dur);
 	bool anim_complete = t_now >= 1.0f;
 
 	bool const change = (c->policy!=policy) || (c->ez.type!=ez.type) ||
@@ -1061,10 +1159,13 @@ int iam_tween_int(ImGuiID id, ImGuiID channel_id, int target, float dur, iam_eas
 		c = g_int.get(key);
 		c->current = c->start = c->target = init_value;
 	}
+	if (enter_domain(c)) return c->current;  // Paused time domain
 
 	if (c->sleeping && c->target == target && !c->has_pending) { return c->current; }
+	// Hidden window (iam_set_tween_culling): hold the last value, easing resumes on the next visible call
+	if (c->target == target && !c->has_pending && tween_culled()) return c->current;
 
-	float t_now = c->sleeping ? 1.0f : (float)((g_global_time - c->start_time) / c->dur);
+	float t_now = c->sleeping ? 1.0f : (float)((domain_time(c->domain) - c->start_time) / c->dur);
 	bool anim_complete = t_now >= 1.0f;
 
 	bool const change = (c->policy!=policy) || (c->ez.type!=ez.type) ||
@@ -1094,10 +1195,13 @@ ImVec4 iam_tween_color(ImGuiID id, ImGuiID channel_id, ImVec4 target_srgb, float
 		c = g_color.get(key);
 		c->current = c->start = c->target = init_value;
 	}
+	if (enter_domain(c)) return c->current;  // Paused time domain
 
 	if (c->sleeping && (fabsf(c->target.x-target_srgb.x)+fabsf(c->target.y-target_srgb.y)+fabsf(c->target.z-target_srgb.z)+fabsf(c->target.w-target_srgb.w)) <= 1e-6f) { return c->current; }
+	// Hidden window (iam_set_tween_culling): hold the last value, easing resumes on the next visible call
+	if ((fabsf(c->target.x-target_srgb.x)+fabsf(c->target.y-target_srgb.y)+fabsf(c->target.z-target_srgb.z)+fabsf(c->target.w-target_srgb.w)) <= 1e-6f && c->space == color_space && tween_culled()) return c->current;
 
-	float t_now = c->sleeping ? 1.0f : (float)((g_global_time - c->start_time) / c->dur);
+	float t_now = c->sleeping ? 1.0f : (float)((domain_time(c->domain) - c->start_time) / c->dur);
 	bool anim_complete = t_now >= 1.0f;
 
 	bool const change = (c->policy!=policy) || (c->space != color_space) || (c->ez.type!=ez.type) ||
@@ -1163,6 +1267,13 @@ ImVec4 iam_tween_color_per_axis(ImGuiID id, ImGuiID channel_id, ImVec4 target_sr
 	iam_detail::float_chan* cb = iam_detail::g_float.get(key_b);
 	iam_detail::float_chan* ca = iam_detail::g_float.get(key_a);
 
+	// Time domain (iam_push_time_domain): a paused domain holds the value
+	bool held = iam_detail::enter_domain(cr);
+	iam_detail::enter_domain(cg);
+	iam_detail::enter_domain(cb);
+	iam_detail::enter_domain(ca);
+	if (held) return iam_detail::color::from_space(ImVec4(cr->current, cg->current, cb->current, ca->current), color_space);
+
 	// Check if this is a new animation (target changed)
 	bool change_r = fabsf(cr->target - target_work.x) > 1e-6f || cr->t >= 1.0f;
 	bool change_g = fabsf(cg->target - target_work.y) > 1e-6f || cg->t >= 1.0f;
@@ -1233,7 +1344,7 @@ void iam_rebase_vec2(ImGuiID id, ImGuiID channel_id, ImVec2 new_target, float dt
 	float remain = (1.0f - (c->progress() < 1.0f ? c->t : 1.0f)) * c->dur;
 	c->start = c->current;
 	c->target = new_target;
-	c->start_time = iam_detail::g_global_time; c->sleeping = 0;
+	c->start_time = iam_detail::domain_time(c->domain); c->sleeping = 0;
 	c->dur = (remain <= 1e-6f ? 1e-6f : remain);
 }
 
@@ -1287,7 +1398,7 @@ void iam_rebase_float(ImGuiID id, ImGuiID channel_id, float new_target, float dt
 	float remain = (1.0f - (c->progress() < 1.0f ? c->t : 1.0f)) * c->dur;
 	c->start = c->current;
 	c->target = new_target;
-	c->start_time = iam_detail::g_global_time; c->sleeping = 0;
+	c->start_time = iam_detail::domain_time(c->domain); c->sleeping = 0;
 	c->dur = (remain <= 1e-6f ? 1e-6f : remain);
 }
 
@@ -1300,7 +1411,7 @@ void iam_rebase_vec4(ImGuiID id, ImGuiID channel_id, ImVec4 new_target, float dt
 	float remain = (1.0f - (c->progress() < 1.0f ? c->t : 1.0f)) * c->dur;
 	c->start = c->current;
 	c->target = new_target;
-	c->start_time = iam_detail::g_global_time; c->sleeping = 0;
+	c->start_time = iam_detail::domain_time(c->domain); c->sleeping = 0;
 	c->dur = (remain <= 1e-6f ? 1e-6f : remain);
 }
 
@@ -1313,7 +1424,7 @@ void iam_rebase_color(ImGuiID id, ImGuiID channel_id, ImVec4 new_target, float d
 	float remain = (1.0f - (c->progress() < 1.0f ? c->t : 1.0f)) * c->dur;
 	c->start = c->current;
 	c->target = new_target;
-	c->start_time = iam_detail::g_global_time; c->sleeping = 0;
+	c->start_time = iam_detail::domain_time(c->domain); c->sleeping = 0;
 	c->dur = (remain <= 1e-6f ? 1e-6f : remain);
 }
 
@@ -1326,7 +1437,7 @@ void iam_rebase_int(ImGuiID id, ImGuiID channel_id, int new_target, float dt) {
 	float remain = (1.0f - (c->progress() < 1.0f ? c->t : 1.0f)) * c->dur;
 	c->start = c->current;
 	c->target = new_target;
-	c->start_time = iam_detail::g_global_time; c->sleeping = 0;
+	c->start_time = iam_detail::domain_time(c->domain); c->sleeping = 0;
 	c->dur = (remain <= 1e-6f ? 1e-6f : remain);
 }
 
@@ -1424,7 +1535,26 @@ struct iam_track {
 	int					anchor_space;	// iam_anchor_space (window_content, window, viewport, etc.)
 	int					anchor_axis;	// For float: 0=x, 1=y (ignored for vec2/vec4)
 
-	iam_track() : channel(0), type(0), color_space(iam_col_oklab), is_relative(false), anchor_space(0), anchor_axis(0) {}
+	int					value_offset;	// First float of this track in the instance value block
+	int					var_offset;		// First float of this track's keys in the instance variation cache, -1 if no key varies
+
+	// Baked samples (iam_clip_bake): bake_count uniform samples from bake_t0, track_value_size floats each
+	ImVector<float>		baked;
+	float				bake_t0;
+	float				bake_rate;		// Samples per second
+	int					bake_count;
+
+	// Packed keys (iam_clip_pack_open): SoA arrays used in place from the pack memory, keys stays empty
+	int					packed_count;
+	float const*		packed_times;
+	float const*		packed_values;	// track_value_size floats per key
+	int const*			packed_eases;
+	int const*			packed_flags;	// PACK_KEY_* bits
+	float const*		packed_params;	// 4 floats per key: bezier, or spring mass/stiffness/damping/velocity
+
+	iam_track() : channel(0), type(0), color_space(iam_col_oklab), is_relative(false), anchor_space(0), anchor_axis(0), value_offset(0), var_offset(-1),
+		bake_t0(0), bake_rate(0), bake_count(0),
+		packed_count(0), packed_times(nullptr), packed_values(nullptr), packed_eases(nullptr), packed_flags(nullptr), packed_params(nullptr) {}
 };
 
 // Timeline marker
@@ -1447,6 +1577,23 @@ struct iam_clip_data {
 	int						direction;		// iam_direction
 	ImVector<iam_clip_detail::iam_track>	iam_tracks;
 
+	// Channel index (built at end()/load): channel_key(channel, kind) -> track index+1
+	ImGuiStorage			channel_index;
+	int						value_count;	// Floats per instance value block (sum of track value sizes)
+	unsigned				layout_version;	// Bumped whenever tracks are rebuilt, unique across clips
+	unsigned				key_version;	// Bumped when key data changes (rebuilds and iam_clip_*_key edits)
+	int						var_value_count;	// Floats per instance variation cache (0 when no key has variation)
+
+	// Baking (iam_clip_bake)
+	float					bake_rate;			// 0 = not baked
+	int						bake_bytes;			// Memory held by baked tables
+	float					bake_max_error;		// Largest baked-vs-live difference measured at bake time
+
+	// Streaming (iam_clip_library_*)
+	int						library_entry;		// Library entry managing this clip, -1 if none
+	void*					stream_data;		// Owned pack region the packed tracks point into
+	size_t					stream_size;
+
 	// Timeline markers
 	ImVector<iam_clip_detail::iam_marker>	markers;
 
@@ -1483,7 +1630,8 @@ struct iam_clip_data {
 	iam_variation_float		delay_var;
 	iam_variation_float		timescale_var;
 
-	iam_clip_data() : id(0), delay(0), duration(0), loop_count(0), direction(iam_dir_normal),
+	iam_clip_data() : id(0), delay(0), duration(0), loop_count(0), direction(iam_dir_normal), value_count(0), layout_version(0), key_version(0), var_value_count(0),
+		bake_rate(0), bake_bytes(0), bake_max_error(0), library_entry(-1), stream_data(nullptr), stream_size(0),
 		cb_begin(nullptr), cb_update(nullptr), cb_complete(nullptr),
 		cb_begin_user(nullptr), cb_update_user(nullptr), cb_complete_user(nullptr),
 		build_time_offset(0), stagger_count(0), stagger_delay(0), stagger_center_bias(0),
@@ -1505,25 +1653,33 @@ struct iam_instance_data {
 	bool		playing;
 	bool		paused;
 	bool		begin_called;	// iam_track whether on_begin has been called
+	bool		pending_load;	// Waiting for its clip to stream in (iam_clip_library_*)
 	int			dir_sign;
 	int			loops_left;
 	unsigned	last_seen_frame;
 
-	// Per-channel current values (cached after evaluation)
-	ImGuiStorage	values_float;
-	ImGuiStorage	values_int;
-	// vec2/vec4/color stored as float pairs/quads in separate arrays
+	// Per-channel current values, one float run per track at iam_track::value_offset
+	// (ints are stored bit-for-bit, relative tracks keep unresolved percent + px_bias)
+	ImVector<float>	values;
+	unsigned		values_layout;	// iam_clip_data::layout_version the block was sized for
+
+	// Lazy evaluation: the block is due at eval_time; tracks are brought up to date when read
+	float			eval_time;
+	unsigned		eval_serial;		// Bumped whenever eval_time is set
+	unsigned		eval_all_serial;	// eval_serial at which every track was evaluated
+	ImVector<unsigned> track_serial;	// Per-track eval_serial the track was last evaluated at
+
+	// Queued by the evaluate phase of iam_clip_update, fired in order by the dispatch phase
+	int				pending_events;			// clip_event_* bits
+	ImVector<int>	pending_markers;		// Indices into iam_clip_data::markers crossed this frame, -1 = loop wrap, -2 = next playlist entry
+	int				frame_tracks_evaluated;	// Eval counters gathered per instance, summed at dispatch
+	int				frame_tracks_deferred;
+	int				frame_tracks_lazy;
+
+	// Entry types used by layered blending
 	struct vec2_entry { ImGuiID ch; ImVec2 v; };
 	struct vec4_entry { ImGuiID ch; ImVec4 v; };
 	struct color_entry { ImGuiID ch; ImVec4 v; int color_space; };
-	// Relative types need 8 floats: percent(4) + px_bias(4)
-	struct vec4_rel_entry { ImGuiID ch; ImVec4 percent; ImVec4 px_bias; };
-	struct color_rel_entry { ImGuiID ch; ImVec4 percent; ImVec4 px_bias; int color_space; };
-	ImVector<vec2_entry> values_vec2;
-	ImVector<vec4_entry> values_vec4;
-	ImVector<color_entry> values_color;
-	ImVector<vec4_rel_entry> values_vec4_rel;
-	ImVector<color_rel_entry> values_color_rel;
 
 	// Layered blending output (written by iam_layer_end)
 	ImGuiStorage	blended_float;
@@ -1533,8 +1689,10 @@ struct iam_instance_data {
 	ImVector<color_entry> blended_color;
 	bool			has_blended;	// true if blended values are valid
 
-	// Marker tracking - bitset for triggered markers (reset on loop)
-	ImVector<bool>	markers_triggered;
+	// Marker tracking over the time-sorted markers of the clip. Playing forward, marker_cursor is the first
+	// marker not crossed yet in the current pass; playing backward, it is one past the last one not crossed.
+	int				marker_cursor;
+	unsigned		marker_layout;	// iam_clip_data::layout_version the cursor was placed for
 	float			prev_time;		// Previous time for marker crossing detection
 
 	// Animation chaining - next clip to play when this one completes
@@ -1542,40 +1700,732 @@ struct iam_instance_data {
 	ImGuiID		chain_next_inst_id;		// Instance ID for next clip (0 = auto-generate)
 	float		chain_delay;			// Delay before starting chained clip
 
+	// Playlist playback (iam_play_playlist): clip_id follows the current entry
+	ImGuiID		playlist_id;			// 0 = plain clip
+	int			playlist_index;			// Current entry
+
+	ImGuiID		sm_player_id;			// State machine player this instance plays a state for (0 = none)
+	int			time_domain;			// Time domain slot (iam_detail::g_domains), 0 = default
+
 	// Loop variation tracking
 	int			current_loop;			// Current loop iteration (0-based), used for variation calculations
 	unsigned int var_rng_state;			// RNG state for deterministic variation random
+	ImVector<float> var_keys;			// Varied key values for current_loop, laid out per track at var_offset
+	int			var_loop;				// Loop the cache was resolved for (-1 = stale)
+	unsigned	var_layout;				// Clip key_version the cache was resolved for
+
+	// Instanced playback (iam_play_instanced): lane l runs lane_stagger * l behind lane_clock
+	int				lane_count;			// 0 = regular instance
+	float			lane_stagger;
+	float			lane_clock;
+	ImVector<float>	lane_time;			// Per-lane clip time
+	ImVector<float>	lane_values;		// Component c of value slot s for lane l at [(s + c) * lane_count + l]
+
+	// Fixed tick rate (iam_clip_set_tick_rate): reads blend the previous tick's values with the current ones
+	bool			realtime;			// Opted out: evaluated on every update, read as is
+	ImVector<float>	tick_prev;			// Value block of the previous tick
+	ImVector<ImU8>	tick_prev_valid;	// Per track: 1 if tick_prev holds it (lazy tracks left unread hold nothing)
+	unsigned		tick_prev_layout;	// values_layout of tick_prev, 0 = none (read current values as is)
+	unsigned		tick_serial;		// iam_clip_system::tick_serial of the last tick evaluation
+
+	// Visibility culling (iam_instance::set_visible / set_cull_rect): culled instances defer evaluation to reads
+	bool			hidden;				// Manual hint
+	bool			cull_rect;			// Visibility comes from set_cull_rect
+	bool			cull_visible;		// Rect visible at the last set_cull_rect
+	unsigned		cull_frame;			// frame_counter at the last set_cull_rect
+	bool			culled;				// Culled in the current iam_clip_update
+
+	// Update budget (iam_clip_set_update_budget): evaluation queued for the scheduler, in priority order
+	int				priority;			// Higher evaluates first
+	bool			budget_due;			// Evaluation requested and not done yet (values are stale)
+	float			budget_time;		// Time to evaluate at (latest request)
+	int				budget_wait;		// Updates the request has been deferred for (raises its priority)
+
+	// Slab bookkeeping (see iam_instance_slab)
+	int			slot;					// Stable slot index
+	unsigned	generation;				// Bumped each time the slot is freed
 
 	iam_instance_data() : inst_id(0), clip_id(0), time(0), time_scale(1.0f), weight(1.0f),
-		delay_left(0), playing(false), paused(false), begin_called(false), dir_sign(1), loops_left(0), last_seen_frame(0),
-		has_blended(false), prev_time(0), chain_next_clip_id(0), chain_next_inst_id(0), chain_delay(0),
-		current_loop(0), var_rng_state(12345) {}
+		delay_left(0), playing(false), paused(false), begin_called(false), pending_load(false), dir_sign(1), loops_left(0), last_seen_frame(0),
+		values_layout(0), eval_time(0), eval_serial(0), eval_all_serial(0),
+		pending_events(0), frame_tracks_evaluated(0), frame_tracks_deferred(0), frame_tracks_lazy(0), has_blended(false), marker_cursor(0), marker_layout(0), prev_time(0), chain_next_clip_id(0), chain_next_inst_id(0), chain_delay(0),
+		playlist_id(0), playlist_index(0), sm_player_id(0), time_domain(0),
+		current_loop(0), var_rng_state(12345), var_loop(-1), var_layout(0), lane_count(0), lane_stagger(0), lane_clock(0),
+		realtime(false), tick_prev_layout(0), tick_serial(0), hidden(false), cull_rect(false), cull_visible(false), cull_frame(0), culled(false),
+		priority(0), budget_due(false), budget_time(0), budget_wait(0), slot(0), generation(0) {}
+
+	// Return to the default state for slot reuse, keeping every buffer's capacity
+	void recycle() {
+		inst_id = 0; clip_id = 0;
+		time = 0; time_scale = 1.0f; weight = 1.0f; delay_left = 0;
+		playing = false; paused = false; begin_called = false; pending_load = false;
+		dir_sign = 1; loops_left = 0; last_seen_frame = 0;
+		values.resize(0); values_layout = 0;
+		eval_time = 0; eval_serial = 0; eval_all_serial = 0;
+		track_serial.resize(0);
+		pending_events = 0; pending_markers.resize(0);
+		frame_tracks_evaluated = 0; frame_tracks_deferred = 0; frame_tracks_lazy = 0;
+		blended_float.Data.resize(0); blended_int.Data.resize(0);
+		blended_vec2.resize(0); blended_vec4.resize(0); blended_color.resize(0);
+		has_blended = false;
+		marker_cursor = 0; marker_layout = 0; prev_time = 0;
+		chain_next_clip_id = 0; chain_next_inst_id = 0; chain_delay = 0;
+		playlist_id = 0; playlist_index = 0; sm_player_id = 0; time_domain = 0;
+		current_loop = 0; var_rng_state = 12345;
+		var_keys.resize(0); var_loop = -1; var_layout = 0;
+		lane_count = 0; lane_stagger = 0; lane_clock = 0;
+		lane_time.resize(0); lane_values.resize(0);
+		realtime = false; tick_prev.resize(0); tick_prev_valid.resize(0); tick_prev_layout = 0; tick_serial = 0;
+		hidden = false; cull_rect = false; cull_visible = false; cull_frame = 0; culled = false;
+		priority = 0; budget_due = false; budget_time = 0; budget_wait = 0;
+	}
 };
 
 namespace iam_clip_detail {
 
+// Instance slab: fixed-size pages so instance addresses never move, freed slots recycled through a free list.
+// Slots keep their buffers when freed, so play/stop churn does no per-play heap allocation once warm.
+struct iam_instance_slab {
+	enum { PAGE_SHIFT = 8, PAGE_SIZE = 1 << PAGE_SHIFT };
+	ImVector<iam_instance_data*>	pages;
+	ImVector<int>					free_slots;
+	int								slot_count;		// High-water mark (slots ever handed out)
+	int								live_count;
+
+	iam_instance_slab() : slot_count(0), live_count(0) {}
+
+	iam_instance_data* at(int slot) { return &pages[slot >> PAGE_SHIFT][slot & (PAGE_SIZE - 1)]; }
+
+	int alloc() {
+		int slot;
+		if (free_slots.Size > 0) {
+			slot = free_slots.back();
+			free_slots.pop_back();
+		} else {
+			if (slot_count == pages.Size * PAGE_SIZE) {
+				iam_instance_data* page = (iam_instance_data*)IM_ALLOC(sizeof(iam_instance_data) * PAGE_SIZE);
+				for (int i = 0; i < PAGE_SIZE; ++i) {
+					IM_PLACEMENT_NEW(&page[i]) iam_instance_data();
+					page[i].slot = pages.Size * PAGE_SIZE + i;
+				}
+				pages.push_back(page);
+			}
+			slot = slot_count++;
+		}
+		live_count++;
+		return slot;
+	}
+
+	void release(int slot) {
+		iam_instance_data* inst = at(slot);
+		inst->recycle();
+		inst->generation++;
+		free_slots.push_back(slot);
+		live_count--;
+	}
+
+	void reserve(int count) {
+		pages.reserve((count + PAGE_SIZE - 1) >> PAGE_SHIFT);
+		free_slots.reserve(count);
+	}
+
+	void clear() {
+		for (int p = 0; p < pages.Size; ++p) {
+			for (int i = 0; i < PAGE_SIZE; ++i) pages[p][i].~iam_instance_data();
+			IM_FREE(pages[p]);
+		}
+		pages.clear();
+		free_slots.clear();
+		slot_count = 0;
+		live_count = 0;
+	}
+};
+
+// ----------------------------------------------------
+// Clip packs - versioned, memory-mappable multi-clip files used in place
+// ----------------------------------------------------
+// Layout (all fields 4 bytes, little-endian, offsets from the pack start):
+//   iam_pack_header
+//   iam_pack_clip_entry[clip_count]           sorted by id, covered by index_checksum
+//   per clip: iam_pack_clip, iam_pack_track[track_count], iam_pack_marker[marker_count],
+//             then 16-byte aligned SoA blobs per track (times, values, eases, flags, params),
+//             all covered by the entry's checksum
+
+static char const IAM_PACK_MAGIC[4] = { 'I', 'A', 'M', 'P' };
+static ImU32 const IAM_PACK_VERSION = 1;
+
+enum pack_key_flags {
+	PACK_KEY_BEZIER	= 1 << 0,
+	PACK_KEY_SPRING	= 1 << 1
+};
+
+struct iam_pack_header {
+	char		magic[4];
+	ImU32		version;
+	ImU32		clip_count;
+	ImU32		index_offset;
+	ImU32		total_size;
+	ImU32		index_checksum;
+};
+
+struct iam_pack_clip_entry {
+	ImGuiID		id;
+	ImU32		offset;			// iam_pack_clip record
+	ImU32		size;			// Bytes of this clip's region
+	ImU32		checksum;		// ImHashData of the region
+};
+
+struct iam_pack_clip {
+	float		duration;
+	float		delay;
+	int			loop_count;
+	int			direction;
+	int			stagger_count;
+	float		stagger_delay;
+	float		stagger_center_bias;
+	ImU32		track_count;
+	ImU32		marker_count;
+};
+
+struct iam_pack_track {
+	ImGuiID		channel;
+	int			type;
+	int			color_space;
+	int			is_relative;
+	int			anchor_space;
+	int			anchor_axis;
+	int			key_count;
+	ImU32		times;
+	ImU32		values;
+	ImU32		eases;
+	ImU32		flags;
+	ImU32		params;
+};
+
+struct iam_pack_marker {
+	float		time;
+	ImGuiID		marker_id;
+};
+
+// An open pack. Memory is either caller-owned, a file mapping, or a heap copy
+struct iam_clip_pack {
+	unsigned char const*		data;
+	size_t						size;
+	iam_pack_clip_entry const*	index;
+	int							clip_count;
+	int							storage;		// 0 = caller memory, 1 = mapped file, 2 = heap
+	void*						map_handle;		// Win32 mapping handle
+	ImGuiID						id;				// Handle returned by iam_clip_pack_open*
+};
+
+// ----------------------------------------------------
+// Streaming clip library - clips known by location, loaded on first play, evicted under a budget
+// ----------------------------------------------------
+
+enum library_state {
+	library_unloaded = 0,
+	library_loading,
+	library_resident
+};
+
+// One file read, run inline or on a worker through the submit hook. Only the request is touched off-thread.
+struct iam_clip_stream_request {
+	char*				path;			// Owned copy
+	ImU32				offset;
+	ImU32				size;			// 0 = whole file
+	unsigned char*		data;			// Result (owned until applied)
+	size_t				data_size;
+	std::atomic<int>	state;			// 0 = in flight, 1 = done, 2 = failed
+};
+
+struct iam_library_source {
+	int			path_offset;	// Into iam_clip_library::path_pool
+	bool		is_pack;
+};
+
+struct iam_library_entry {
+	ImGuiID		clip_id;
+	int			source;
+	ImU32		offset;			// Pack region (whole file for single-clip sources)
+	ImU32		size;
+	ImU32		checksum;
+	int			state;			// library_state
+	unsigned	last_used;		// LRU stamp, bumped by iam_play
+	size_t		bytes;			// Resident memory while loaded
+	iam_clip_stream_request*	request;
+};
+
+struct iam_clip_library {
+	ImVector<iam_library_entry>		entries;
+	ImGuiStorage					entry_map;		// clip_id -> entry+1
+	ImVector<iam_library_source>	sources;
+	ImVector<char>					path_pool;
+	size_t							budget;			// 0 = unlimited
+	size_t							resident_bytes;
+	unsigned						use_serial;
+	int								loading;
+	iam_clip_submit_fn				submit;
+	void*							submit_user;
+
+	iam_clip_library() : budget(0), resident_bytes(0), use_serial(0), loading(0), submit(nullptr), submit_user(nullptr) {}
+};
+
+// Public instance handle: slot+1 in the low bits, slot generation above
+static unsigned const INST_HANDLE_SLOT_BITS = 20;
+static unsigned const INST_HANDLE_SLOT_MASK = (1u << INST_HANDLE_SLOT_BITS) - 1;
+
+// ----------------------------------------------------
+// Blend graphs - persistent layering built once, evaluated in one pass per iam_clip_update
+// ----------------------------------------------------
+
+enum blend_node_kind {
+	blend_node_source = 0,
+	blend_node_blend,
+	blend_node_additive,
+	blend_node_override
+};
+
+struct iam_blend_node {
+	int			kind;
+	float		weight;			// Read by the node consuming this one
+	ImGuiID		instance_id;	// Source
+	int			input_begin;	// Range in iam_blend_graph::inputs (additive/override: base, layer)
+	int			input_count;
+	int			mask_channel_begin;	// Override: authored channels in mask_channels
+	int			mask_channel_count;	// 0 = every channel
+	int			mask_begin;		// Override: slot_count flags in masks, -1 = every channel
+	ImGuiID		clip_id;		// Source binding: clip layout the track map was built for
+	unsigned	layout_version;
+	int			map_begin;		// Source: clip track index -> slot, in track_slot
+	int			map_count;
+};
+
+// A graph channel. Values are kept in the slot's color space (colors) and unresolved (relative types)
+struct iam_blend_slot {
+	ImGuiID		channel;
+	int			type;			// Type of the first source track seen for the channel
+	int			offset;			// Float offset in a node value block
+	int			comps;
+	int			color_space;
+	int			anchor_space;
+	int			anchor_axis;
+};
+
+struct iam_blend_graph {
+	ImGuiID						id;
+	ImVector<iam_blend_node>	nodes;			// Inputs always precede their consumers; the last node is the output
+	ImVector<int>				inputs;
+	ImVector<ImGuiID>			mask_channels;	// Override masks as authored (resolved to slot flags in masks)
+	ImVector<unsigned char>		masks;
+	ImVector<iam_blend_slot>	slots;
+	ImGuiStorage				slot_index;		// channel_key(channel, kind) -> slot+1
+	ImVector<int>				track_slot;
+	int							value_count;
+	ImVector<float>				values;			// node_count * value_count
+	ImVector<unsigned char>		present;		// node_count * slot_count: node defines the channel
+	ImVector<float>				acc_weight;		// Blend scratch, slot_count
+	ImVector<float>				output;			// value_count; colors in sRGB
+	ImVector<unsigned char>		output_present;
+	bool						valid;			// False when a node referenced a missing input
+
+	iam_blend_graph() : id(0), value_count(0), valid(true) {}
+};
+
+// Event queue (iam_clip_set_event_queue): single-producer/single-consumer ring. The producer is the dispatch
+// phase of iam_clip_update; the consumer (iam_poll_events) may run on another thread.
+struct iam_event_ring {
+	iam_event*				data;
+	unsigned				mask;			// Capacity - 1, capacity is a power of two
+	std::atomic<unsigned>	head;			// Next slot written (producer)
+	std::atomic<unsigned>	tail;			// Next slot read (consumer)
+	std::atomic<unsigned>	dropped;
+
+	iam_event_ring() : data(nullptr), mask(0), head(0), tail(0), dropped(0) {}
+};
+
+// One block of the shared evaluation cache; the lookup key is a hash, so hits are verified against these fields
+struct iam_eval_cache_entry {
+	unsigned	key_version;	// iam_clip_data::key_version of the clip evaluated
+	float		time;			// Quantized evaluation time
+	int			value_count;
+	int			offset;			// Into eval_cache_values
+};
+
+// Clips played back to back by one instance (iam_play_playlist)
+struct iam_playlist_data {
+	ImGuiID				id;
+	ImVector<ImGuiID>	clips;
+	ImVector<float>		start;			// Entry start times (delay included), clips.Size + 1 entries; the last is the total
+	unsigned			start_serial;	// layout_serial start was computed for
+
+	iam_playlist_data() : id(0), start_serial(0) {}
+};
+
+// State machine asset (iam_state_machine_begin/end). Transitions refer to states by index once resolved.
+struct iam_sm_state {
+	ImGuiID	id;
+	ImGuiID	clip_id;
+};
+
+struct iam_sm_cond {
+	ImGuiID	param;
+	int		op;				// iam_sm_condition
+	float	value;
+};
+
+struct iam_sm_transition {
+	ImGuiID	from_id, to_id;	// As authored (from_id 0 = any state)
+	int		from, to;		// Resolved state indices (from -1 = any, to -1 = unknown state: never taken)
+	float	crossfade;
+	int		cond_begin;		// Range in iam_state_machine::conds
+	int		cond_count;
+};
+
+struct iam_state_machine {
+	ImGuiID						id;
+	ImVector<iam_sm_state>		states;
+	ImVector<iam_sm_transition>	transitions;	// In priority order
+	ImVector<iam_sm_cond>		conds;
+	ImGuiStorage				state_index;	// state_id -> index+1
+
+	iam_state_machine() : id(0) {}
+};
+
+// One state machine running for one widget. The current state's instance has weight fade; while fading, the
+// previous state's instance keeps playing with weight 1 - fade.
+struct iam_sm_player {
+	ImGuiID			id;
+	ImGuiID			machine_id;
+	ImGuiID			state_id;
+	ImGuiID			inst_id;
+	ImGuiID			prev_state_id;	// 0 = not fading
+	ImGuiID			prev_inst_id;
+	float			fade;			// 0..1
+	float			fade_duration;
+	ImGuiStorage	params;			// param id -> float
+	unsigned		last_seen_frame;
+
+	iam_sm_player() : id(0), machine_id(0), state_id(0), inst_id(0), prev_state_id(0), prev_inst_id(0),
+		fade(1.0f), fade_duration(0), last_seen_frame(0) {}
+};
+
+// Suspended coroutine script (iam_task) and what it waits for
+struct iam_task_wait {
+	unsigned	task_id;
+	void*		handle;			// std::coroutine_handle address (nullptr once cancelled)
+	ImGuiID		instance_id;	// Instance completion / marker waits
+	ImGuiID		marker_id;		// Marker waits (0 = completion)
+	double		wake_time;		// Timer waits: task clock to resume at
+	unsigned	seq;			// Timer waits: FIFO among equal wake times
+};
+
+// Instance waiting for the update budget scheduler
+struct iam_budget_entry {
+	int		key;		// priority + updates waited
+	int		slot;
+};
+
 // Global clip system state
 static struct iam_clip_system {
 	ImVector<iam_clip_data>		clips;
-	ImVector<iam_instance_data>	instances;
+	iam_instance_slab			instances;
 	ImGuiStorage				clip_map;		// clip_id -> index+1
-	ImGuiStorage				inst_map;		// inst_id -> index+1
+	ImGuiStorage				inst_map;		// inst_id -> slot+1
+	ImVector<iam_clip_pack>		packs;			// Open clip packs, searched when a clip id is not registered
+	iam_clip_library			library;
+	ImVector<iam_blend_graph*>	graphs;
+	ImGuiStorage				graph_map;		// graph_id -> index+1
+	ImVector<iam_playlist_data*> playlists;
+	ImGuiStorage				playlist_map;	// playlist_id -> index+1
+	iam_blend_graph*			graph_build;	// Graph between iam_blend_graph_begin/end
+	ImVector<iam_state_machine*> machines;
+	ImGuiStorage				machine_map;	// machine_id -> index+1
+	iam_state_machine*			machine_build;	// Machine between iam_state_machine_begin/end
+	ImVector<iam_sm_player*>	players;
+	ImGuiStorage				player_map;		// player_id -> index+1
+	ImVector<ImGuiID>			players_dirty;	// Players whose state clip completed in this update
+	ImVector<ImGuiID>			players_fading;	// Players crossfading (the only ones iam_clip_update advances)
+	iam_event_ring				events;
 	unsigned					frame_counter;
+	unsigned					layout_serial;	// Source of iam_clip_data::layout_version and key_version
 	bool						initialized;
 
-	iam_clip_system() : frame_counter(0), initialized(false) {}
+	// Lazy evaluation (iam_clip_set_lazy_eval) and per-frame counters, reset by iam_clip_update
+	bool						lazy_eval;
+	int							stat_tracks_evaluated;	// Tracks evaluated (eagerly or on read)
+	int							stat_tracks_deferred;	// Tracks whose evaluation was deferred to read time
+	int							stat_tracks_lazy;		// Deferred tracks that were later read
+	int							stat_instances_culled;	// Instances whose evaluation was deferred by culling
+
+	// Multi-threaded update (iam_clip_set_parallel_for)
+	iam_parallel_for_fn			parallel_for;
+	void*						parallel_for_user;
+	int							parallel_grain;
+	bool						in_parallel;	// Evaluate phase is running on worker threads
+
+	// Shared evaluation cache (iam_clip_set_eval_cache): value blocks keyed by (clip layout, quantized time),
+	// flushed every iam_clip_update
+	bool						eval_cache;
+	float						eval_cache_quantum;		// 0 = exact time match
+	ImGuiStorage				eval_cache_index;		// key hash -> index+1 into eval_cache_entries
+	ImVector<iam_eval_cache_entry>	eval_cache_entries;
+	ImVector<float>				eval_cache_values;
+	int							stat_cache_hits;
+	int							stat_cache_misses;
+
+	// Fixed tick rate (iam_clip_set_tick_rate): tracks are evaluated on ticks only, reads interpolate between ticks
+	float						tick_interval;	// Seconds per tick, 0 = evaluate every update
+	float						tick_accum;		// Time since the last tick
+	float						tick_alpha;		// Read position from the previous tick (0) to the current one (1)
+	unsigned					tick_serial;	// Bumped on every tick
+	bool						tick_due;		// This update is a tick
+
+	// Update budget (iam_clip_set_update_budget): track evaluation is scheduled by priority until the budget is spent
+	float						budget_us;		// 0 = unlimited
+	ImVector<iam_budget_entry>	budget_order;	// Scratch: due instances, sorted by the scheduler
+	iam_clip_budget_stats		budget_stats;
+
+	// Coroutine scripts (iam_task): a task is only touched when what it waits for happens
+	ImVector<iam_task_wait>		task_timers;	// Min-heap on (wake_time, seq)
+	ImVector<iam_task_wait>		task_inst_waits;
+	ImVector<iam_task_wait>		task_marker_waits;
+	ImVector<iam_task_wait>		task_ready;		// Woken; resumed at the end of iam_clip_update
+	ImVector<iam_task_wait>		task_resuming;	// Scratch: the batch being resumed
+	ImGuiStorage				task_live;		// task id -> 1 while the coroutine frame exists
+	unsigned					task_counter;
+	unsigned					task_seq;
+	double						task_time;		// Task clock (scaled dt)
+	void*						task_pool[32];	// Free coroutine frames per 64-byte size class
+
+	iam_clip_system() : graph_build(nullptr), machine_build(nullptr), frame_counter(0), layout_serial(0), initialized(false),
+		lazy_eval(false), stat_tracks_evaluated(0), stat_tracks_deferred(0), stat_tracks_lazy(0), stat_instances_culled(0),
+		parallel_for(nullptr), parallel_for_user(nullptr), parallel_grain(512), in_parallel(false),
+		eval_cache(false), eval_cache_quantum(0), stat_cache_hits(0), stat_cache_misses(0),
+		tick_interval(0), tick_accum(0), tick_alpha(1.0f), tick_serial(0), tick_due(true), budget_us(0),
+		task_counter(0), task_seq(0), task_time(0) {
+		memset(&budget_stats, 0, sizeof(budget_stats));
+		memset(task_pool, 0, sizeof(task_pool));
+	}
 } g_clip_sys;
 
+// Events queued on an instance during the evaluate phase
+enum clip_event {
+	clip_event_begin	= 1 << 0,
+	clip_event_update	= 1 << 1,
+	clip_event_complete	= 1 << 2
+};
+
+static iam_clip_data* activate_packed_clip(ImGuiID clip_id);
+static void materialize_packed_clip(iam_clip_data* clip);
+static void release_pack_storage(iam_clip_pack& pack);
+static iam_clip_data* library_acquire(ImGuiID clip_id, iam_clip_data* clip, bool* out_pending);
+static void library_poll();
+static void library_enforce_budget();
+static void library_forget_clip(iam_clip_data* clip);
+static void release_clip_data(iam_clip_data* clip);
+static void free_stream_request(iam_clip_stream_request* req);
+static void eval_blend_graph(iam_blend_graph* g);
+static void update_state_machines(float dt);
+static void free_sm_player(int idx);
+#ifdef IAM_HAS_COROUTINES
+static void resume_tasks(float dt);
+static void destroy_tasks();
+#endif
+
 static iam_clip_data* find_clip(ImGuiID clip_id) {
 	int idx = g_clip_sys.clip_map.GetInt(clip_id, 0);
-	if (idx == 0) return nullptr;
+	if (idx == 0) return g_clip_sys.packs.Size > 0 ? activate_packed_clip(clip_id) : nullptr;
 	return &g_clip_sys.clips[idx - 1];
 }
 
+// Registered clips only: never activates a packed clip (safe on worker threads)
+static iam_clip_data* find_registered_clip(ImGuiID clip_id) {
+	int idx = g_clip_sys.clip_map.GetInt(clip_id, 0);
+	return idx > 0 ? &g_clip_sys.clips[idx - 1] : nullptr;
+}
+
 static iam_instance_data* find_instance(ImGuiID inst_id) {
 	int idx = g_clip_sys.inst_map.GetInt(inst_id, 0);
 	if (idx == 0) return nullptr;
-	return &g_clip_sys.instances[idx - 1];
+	return g_clip_sys.instances.at(idx - 1);
+}
+
+static ImU32 make_instance_handle(iam_instance_data const* inst) {
+	if ((unsigned)inst->slot >= INST_HANDLE_SLOT_MASK) return 0;  // Slot out of handle range: map lookup only
+	return ((inst->generation & (0xFFFFFFFFu >> INST_HANDLE_SLOT_BITS)) << INST_HANDLE_SLOT_BITS) | (ImU32)(inst->slot + 1);
+}
+
+// O(1) lookup through a handle, validated by generation and id; falls back to the id map for stale/absent handles
+static iam_instance_data* find_instance(ImGuiID inst_id, ImU32 handle) {
+	int slot = (int)(handle & INST_HANDLE_SLOT_MASK) - 1;
+	if (slot >= 0 && slot < g_clip_sys.instances.slot_count) {
+		iam_instance_data* inst = g_clip_sys.instances.at(slot);
+		if (inst->inst_id == inst_id && inst_id != 0 && make_instance_handle(inst) == handle) return inst;
+	}
+	return find_instance(inst_id);
+}
+
+// Move tasks waiting on an instance to the ready list: completion waits (marker_id 0), waits on one marker,
+// or with any_marker, all of its waits
+static void wake_instance_tasks(ImVector<iam_task_wait>& waits, ImGuiID inst_id, ImGuiID marker_id, bool any_marker) {
+	for (int i = 0; i < waits.Size; ) {
+		if (waits[i].instance_id == inst_id && (any_marker || waits[i].marker_id == marker_id)) {
+			g_clip_sys.task_ready.push_back(waits[i]);
+			waits.erase(waits.Data + i);
+		} else {
+			++i;
+		}
+	}
+}
+
+// Release an instance slot back to the slab
+static void free_instance(iam_instance_data* inst) {
+	// Tasks awaiting a destroyed instance resume rather than wait forever
+	if (g_clip_sys.task_inst_waits.Size > 0) wake_instance_tasks(g_clip_sys.task_inst_waits, inst->inst_id, 0, true);
+	if (g_clip_sys.task_marker_waits.Size > 0) wake_instance_tasks(g_clip_sys.task_marker_waits, inst->inst_id, 0, true);
+	g_clip_sys.inst_map.SetInt(inst->inst_id, 0);
+	g_clip_sys.instances.release(inst->slot);
+}
+
+// ----------------------------------------------------
+// Channel index and instance value block layout
+// ----------------------------------------------------
+
+// Number of floats a track occupies in the instance value block
+static int track_value_size(int type) {
+	switch (type) {
+		case iam_chan_float:
+		case iam_chan_int:			return 1;
+		case iam_chan_vec2:
+		case iam_chan_float_rel:	return 2;	// percent, px_bias
+		case iam_chan_vec4:
+		case iam_chan_color:
+		case iam_chan_vec2_rel:		return 4;	// percent.xy, px_bias.xy
+		case iam_chan_vec4_rel:
+		case iam_chan_color_rel:	return 8;	// percent.xyzw, px_bias.xyzw
+		default:					return 0;
+	}
+}
+
+// Getter family a track answers to (relative tracks resolve to their absolute type)
+static int track_value_kind(int type) {
+	switch (type) {
+		case iam_chan_float_rel:	return iam_chan_float;
+		case iam_chan_vec2_rel:		return iam_chan_vec2;
+		case iam_chan_vec4_rel:		return iam_chan_vec4;
+		case iam_chan_color_rel:	return iam_chan_color;
+		default:					return type;
+	}
+}
+
+static ImGuiID channel_key(ImGuiID channel, int kind) {
+	ImGuiID k[2] = { channel, (ImGuiID)kind };
+	return ImHashData(k, sizeof(k));
+}
+
+static void assign_var_offsets(iam_clip_data* clip);
+
+// Assign value slots and index tracks by (channel, kind). Called whenever iam_tracks changes.
+static void build_channel_index(iam_clip_data* clip) {
+	clip->channel_index.Clear();
+	clip->value_count = 0;
+	for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+		iam_track& trk = clip->iam_tracks[t];
+		trk.value_offset = clip->value_count;
+		clip->value_count += track_value_size(trk.type);
+		ImGuiID key = channel_key(trk.channel, track_value_kind(trk.type));
+		if (clip->channel_index.GetInt(key, 0) == 0)
+			clip->channel_index.SetInt(key, t + 1);
+	}
+	assign_var_offsets(clip);
+	clip->layout_version = ++g_clip_sys.layout_serial;
+	clip->key_version = clip->layout_version;
+}
+
+// Tracks with at least one varied key get a slot per key in the instance variation cache
+static void assign_var_offsets(iam_clip_data* clip) {
+	clip->var_value_count = 0;
+	for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+		iam_track& trk = clip->iam_tracks[t];
+		trk.var_offset = -1;
+		if (trk.is_relative) continue;
+		for (int k = 0; k < trk.keys.Size; ++k) {
+			if (!trk.keys[k].has_variation) continue;
+			trk.var_offset = clip->var_value_count;
+			clip->var_value_count += trk.keys.Size * track_value_size(trk.type);
+			break;
+		}
+	}
+}
+
+// Size the instance value block for the clip's current layout (zeroed when the layout changes)
+static void bind_instance_values(iam_instance_data* inst, iam_clip_data const* clip) {
+	if (inst->values_layout == clip->layout_version && inst->values.Size == clip->value_count) return;
+	inst->values.resize(clip->value_count);
+	if (clip->value_count > 0) memset(inst->values.Data, 0, sizeof(float) * clip->value_count);
+	inst->track_serial.resize(clip->iam_tracks.Size);
+	if (clip->iam_tracks.Size > 0) memset(inst->track_serial.Data, 0, sizeof(unsigned) * clip->iam_tracks.Size);
+	inst->eval_all_serial = 0;
+	inst->values_layout = clip->layout_version;
+}
+
+// Find the track answering to (channel, kind) for an instance, or -1 if the block is not bound to it
+static int find_bound_track(iam_instance_data const* inst, iam_clip_data const* clip, ImGuiID channel, int kind) {
+	if (!clip || inst->values_layout != clip->layout_version) return -1;
+	return clip->channel_index.GetInt(channel_key(channel, kind), 0) - 1;
+}
+
+// Read a value block entry of the given channel type; relative types are resolved against their anchor
+static void read_slot_value(int type, int anchor_space, int anchor_axis, float const* src, float* out) {
+	switch (type) {
+		case iam_chan_float:
+			out[0] = src[0];
+			break;
+		case iam_chan_vec2:
+			out[0] = src[0]; out[1] = src[1];
+			break;
+		case iam_chan_vec4:
+		case iam_chan_color:
+			out[0] = src[0]; out[1] = src[1]; out[2] = src[2]; out[3] = src[3];
+			break;
+		case iam_chan_float_rel: {
+			ImVec2 anchor = iam_anchor_size(anchor_space);
+			float base = (anchor_axis == 0) ? anchor.x : anchor.y;
+			out[0] = base * src[0] + src[1];
+			break;
+		}
+		case iam_chan_vec2_rel: {
+			ImVec2 anchor = iam_anchor_size(anchor_space);
+			out[0] = anchor.x * src[0] + src[2];
+			out[1] = anchor.y * src[1] + src[3];
+			break;
+		}
+		case iam_chan_vec4_rel: {
+			// x,y use anchor dimensions, z,w pass through
+			ImVec2 anchor = iam_anchor_size(anchor_space);
+			out[0] = anchor.x * src[0] + src[4];
+			out[1] = anchor.y * src[1] + src[5];
+			out[2] = src[2] + src[6];
+			out[3] = src[3] + src[7];
+			break;
+		}
+		case iam_chan_color_rel: {
+			// anchor.x drives R,B and anchor.y drives G,A
+			ImVec2 anchor = iam_anchor_size(anchor_space);
+			out[0] = anchor.x * src[0] + src[4];
+			out[1] = anchor.y * src[1] + src[5];
+			out[2] = anchor.x * src[2] + src[6];
+			out[3] = anchor.y * src[3] + src[7];
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+// Read a track's current value from the instance value block
+static void read_track_value(iam_track const& trk, float const* src, float* out) {
+	read_slot_value(trk.type, trk.anchor_space, trk.anchor_axis, src, out);
 }
 
 // Evaluate easing for clip keyframes
@@ -1993,255 +2843,755 @@ static bool find_keys(iam_track const& trk, float t, keyframe const** k0, keyfra
 	return true;
 }
 
-// Evaluate a iam_track at time t
-static void eval_iam_track(iam_track const& trk, float t, iam_instance_data* inst) {
-	if (!inst || trk.keys.Size == 0) return;
-	keyframe const* k0; keyframe const* k1;
-	if (!find_keys(trk, t, &k0, &k1)) return;
-	if (!k0 || !k1) return;  // Safety check
-
-	float u = (k1->time == k0->time) ? 1.0f : (t - k0->time) / (k1->time - k0->time);
-	float w;
-	if (k0->is_spring && trk.type == iam_chan_float) {
-		w = eval_clip_spring(u, k0->spring);
-	} else {
-		w = eval_clip_ease(k0->ease_type, u, k0->bezier, k0->has_bezier);
-	}
-
-	// Get current loop index for variation
-	int loop_index = inst->current_loop;
-
-	switch (trk.type) {
-		case iam_chan_float: {
-			float a = k0->get_float(), b = k1->get_float();
-			// Apply variation if present
-			if (k0->has_variation) {
-				a = apply_var_float(a, k0->var_float, loop_index, &inst->var_rng_state);
-			}
-			if (k1->has_variation) {
-				b = apply_var_float(b, k1->var_float, loop_index, &inst->var_rng_state);
-			}
-			float v = a + (b - a) * w;
-			inst->values_float.SetFloat(trk.channel, v);
-			break;
-		}
-		case iam_chan_vec2: {
-			ImVec2 a = k0->get_vec2(), b = k1->get_vec2();
-			// Apply variation if present
-			if (k0->has_variation) {
-				a = apply_var_vec2(a, k0->var_vec2, loop_index, &inst->var_rng_state);
-			}
-			if (k1->has_variation) {
-				b = apply_var_vec2(b, k1->var_vec2, loop_index, &inst->var_rng_state);
-			}
-			ImVec2 v(a.x + (b.x - a.x) * w, a.y + (b.y - a.y) * w);
-			// Store in vec2 array
-			bool found = false;
-			for (int i = 0; i < inst->values_vec2.Size; ++i) {
-				if (inst->values_vec2[i].ch == trk.channel) {
-					inst->values_vec2[i].v = v;
-					found = true;
-					break;
-				}
-			}
-			if (!found) {
-				iam_instance_data::vec2_entry e; e.ch = trk.channel; e.v = v;
-				inst->values_vec2.push_back(e);
-			}
-			break;
-		}
-		case iam_chan_vec4: {
-			ImVec4 a = k0->get_vec4(), b = k1->get_vec4();
-			// Apply variation if present
-			if (k0->has_variation) {
-				a = apply_var_vec4(a, k0->var_vec4, loop_index, &inst->var_rng_state);
-			}
-			if (k1->has_variation) {
-				b = apply_var_vec4(b, k1->var_vec4, loop_index, &inst->var_rng_state);
-			}
-			ImVec4 v(a.x + (b.x - a.x) * w, a.y + (b.y - a.y) * w, a.z + (b.z - a.z) * w, a.w + (b.w - a.w) * w);
-			bool found = false;
-			for (int i = 0; i < inst->values_vec4.Size; ++i) {
-				if (inst->values_vec4[i].ch == trk.channel) {
-					inst->values_vec4[i].v = v;
-					found = true;
-					break;
-				}
-			}
-			if (!found) {
-				iam_instance_data::vec4_entry e; e.ch = trk.channel; e.v = v;
-				inst->values_vec4.push_back(e);
-			}
-			break;
-		}
-		case iam_chan_int: {
-			int a = k0->get_int(), b = k1->get_int();
-			// Apply variation if present
-			if (k0->has_variation) {
-				a = apply_var_int(a, k0->var_int, loop_index, &inst->var_rng_state);
-			}
-			if (k1->has_variation) {
-				b = apply_var_int(b, k1->var_int, loop_index, &inst->var_rng_state);
-			}
-			int v = (int)(a + (int)((float)(b - a) * w + 0.5f));
-			inst->values_int.SetInt(trk.channel, v);
-			break;
-		}
-		case iam_chan_color: {
-			ImVec4 a = k0->get_color(), b = k1->get_color();
-			// Apply variation if present
-			if (k0->has_variation) {
-				a = apply_var_color(a, k0->var_color, loop_index, &inst->var_rng_state);
-			}
-			if (k1->has_variation) {
-				b = apply_var_color(b, k1->var_color, loop_index, &inst->var_rng_state);
-			}
-			// Blend in the specified color space
-			ImVec4 v = iam_detail::color::lerp_color(a, b, w, trk.color_space);
-			bool found = false;
-			for (int i = 0; i < inst->values_color.Size; ++i) {
-				if (inst->values_color[i].ch == trk.channel) {
-					inst->values_color[i].v = v;
-					inst->values_color[i].color_space = trk.color_space;
-					found = true;
+// Resolve every keyed variation of a clip for loop_index into var_keys (clip->var_value_count floats)
+static void resolve_variation_keys(iam_clip_data const* clip, int loop_index, unsigned int* rng_state, float* var_keys) {
+	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
+		iam_track const& trk = clip->iam_tracks[tr];
+		if (trk.var_offset < 0) continue;
+		int n = track_value_size(trk.type);
+		float* dst = var_keys + trk.var_offset;
+		for (int k = 0; k < trk.keys.Size; ++k, dst += n) {
+			keyframe const& key = trk.keys[k];
+			memcpy(dst, key.value, sizeof(float) * n);
+			if (!key.has_variation) continue;
+			switch (trk.type) {
+				case iam_chan_float:
+					dst[0] = apply_var_float(key.get_float(), key.var_float, loop_index, rng_state);
 					break;
-				}
-			}
-			if (!found) {
-				iam_instance_data::color_entry e; e.ch = trk.channel; e.v = v; e.color_space = trk.color_space;
-				inst->values_color.push_back(e);
-			}
-			break;
-		}
-		case iam_chan_float_rel: {
-			// Interpolate percent and px_bias separately, store as vec2 (percent, px_bias)
-			float percent_a = k0->get_float_rel_percent(), percent_b = k1->get_float_rel_percent();
-			float px_bias_a = k0->get_float_rel_px_bias(), px_bias_b = k1->get_float_rel_px_bias();
-			float percent = percent_a + (percent_b - percent_a) * w;
-			float px_bias = px_bias_a + (px_bias_b - px_bias_a) * w;
-			// Store as vec2 for later resolution (percent in x, px_bias in y)
-			ImVec2 v(percent, px_bias);
-			bool found = false;
-			for (int i = 0; i < inst->values_vec2.Size; ++i) {
-				if (inst->values_vec2[i].ch == trk.channel) {
-					inst->values_vec2[i].v = v;
-					found = true;
+				case iam_chan_vec2: {
+					ImVec2 v = apply_var_vec2(key.get_vec2(), key.var_vec2, loop_index, rng_state);
+					dst[0] = v.x; dst[1] = v.y;
 					break;
 				}
-			}
-			if (!found) {
-				iam_instance_data::vec2_entry e; e.ch = trk.channel; e.v = v;
-				inst->values_vec2.push_back(e);
-			}
-			break;
-		}
-		case iam_chan_vec2_rel: {
-			// Interpolate percent and px_bias separately, store as vec4 (percent.xy, px_bias.xy)
-			ImVec2 percent_a = k0->get_vec2_rel_percent(), percent_b = k1->get_vec2_rel_percent();
-			ImVec2 px_bias_a = k0->get_vec2_rel_px_bias(), px_bias_b = k1->get_vec2_rel_px_bias();
-			ImVec2 percent(percent_a.x + (percent_b.x - percent_a.x) * w, percent_a.y + (percent_b.y - percent_a.y) * w);
-			ImVec2 px_bias(px_bias_a.x + (px_bias_b.x - px_bias_a.x) * w, px_bias_a.y + (px_bias_b.y - px_bias_a.y) * w);
-			// Store as vec4 (percent.x, percent.y, px_bias.x, px_bias.y)
-			ImVec4 v(percent.x, percent.y, px_bias.x, px_bias.y);
-			bool found = false;
-			for (int i = 0; i < inst->values_vec4.Size; ++i) {
-				if (inst->values_vec4[i].ch == trk.channel) {
-					inst->values_vec4[i].v = v;
-					found = true;
+				case iam_chan_vec4: {
+					ImVec4 v = apply_var_vec4(key.get_vec4(), key.var_vec4, loop_index, rng_state);
+					dst[0] = v.x; dst[1] = v.y; dst[2] = v.z; dst[3] = v.w;
 					break;
 				}
-			}
-			if (!found) {
-				iam_instance_data::vec4_entry e; e.ch = trk.channel; e.v = v;
-				inst->values_vec4.push_back(e);
-			}
-			break;
-		}
-		case iam_chan_vec4_rel: {
-			// Interpolate percent and px_bias separately
-			ImVec4 percent_a = k0->get_vec4_rel_percent(), percent_b = k1->get_vec4_rel_percent();
-			ImVec4 px_bias_a = k0->get_vec4_rel_px_bias(), px_bias_b = k1->get_vec4_rel_px_bias();
-			ImVec4 percent(
-				percent_a.x + (percent_b.x - percent_a.x) * w,
-				percent_a.y + (percent_b.y - percent_a.y) * w,
-				percent_a.z + (percent_b.z - percent_a.z) * w,
-				percent_a.w + (percent_b.w - percent_a.w) * w
-			);
-			ImVec4 px_bias(
-				px_bias_a.x + (px_bias_b.x - px_bias_a.x) * w,
-				px_bias_a.y + (px_bias_b.y - px_bias_a.y) * w,
-				px_bias_a.z + (px_bias_b.z - px_bias_a.z) * w,
-				px_bias_a.w + (px_bias_b.w - px_bias_a.w) * w
-			);
-			bool found = false;
-			for (int i = 0; i < inst->values_vec4_rel.Size; ++i) {
-				if (inst->values_vec4_rel[i].ch == trk.channel) {
-					inst->values_vec4_rel[i].percent = percent;
-					inst->values_vec4_rel[i].px_bias = px_bias;
-					found = true;
+				case iam_chan_int: {
+					int v = apply_var_int(key.get_int(), key.var_int, loop_index, rng_state);
+					memcpy(dst, &v, sizeof(int));
 					break;
 				}
-			}
-			if (!found) {
-				iam_instance_data::vec4_rel_entry e;
-				e.ch = trk.channel;
-				e.percent = percent;
-				e.px_bias = px_bias;
-				inst->values_vec4_rel.push_back(e);
-			}
-			break;
-		}
-		case iam_chan_color_rel: {
-			// Interpolate percent and px_bias separately (color blending not applied to percent/bias)
-			ImVec4 percent_a = k0->get_color_rel_percent(), percent_b = k1->get_color_rel_percent();
-			ImVec4 px_bias_a = k0->get_color_rel_px_bias(), px_bias_b = k1->get_color_rel_px_bias();
-			ImVec4 percent(
-				percent_a.x + (percent_b.x - percent_a.x) * w,
-				percent_a.y + (percent_b.y - percent_a.y) * w,
-				percent_a.z + (percent_b.z - percent_a.z) * w,
-				percent_a.w + (percent_b.w - percent_a.w) * w
-			);
-			ImVec4 px_bias(
-				px_bias_a.x + (px_bias_b.x - px_bias_a.x) * w,
-				px_bias_a.y + (px_bias_b.y - px_bias_a.y) * w,
-				px_bias_a.z + (px_bias_b.z - px_bias_a.z) * w,
-				px_bias_a.w + (px_bias_b.w - px_bias_a.w) * w
-			);
-			bool found = false;
-			for (int i = 0; i < inst->values_color_rel.Size; ++i) {
-				if (inst->values_color_rel[i].ch == trk.channel) {
-					inst->values_color_rel[i].percent = percent;
-					inst->values_color_rel[i].px_bias = px_bias;
-					inst->values_color_rel[i].color_space = trk.color_space;
-					found = true;
+				case iam_chan_color: {
+					ImVec4 v = apply_var_color(key.get_color(), key.var_color, loop_index, rng_state);
+					dst[0] = v.x; dst[1] = v.y; dst[2] = v.z; dst[3] = v.w;
 					break;
 				}
 			}
-			if (!found) {
-				iam_instance_data::color_rel_entry e;
-				e.ch = trk.channel;
-				e.percent = percent;
-				e.px_bias = px_bias;
-				e.color_space = trk.color_space;
-				inst->values_color_rel.push_back(e);
-			}
-			break;
 		}
 	}
 }
 
-// Sort keyframes by time
-static int cmp_keyframe(void const* a, void const* b) {
-	keyframe const* A = (keyframe const*)a;
-	keyframe const* B = (keyframe const*)b;
-	if (A->time < B->time) return -1;
-	if (A->time > B->time) return 1;
-	return 0;
+// Resolve every keyframe variation for the instance's current loop into its variation cache.
+// Runs once per loop iteration (or layout change), so variation callbacks, color conversions and
+// the random stream advance per loop rather than per frame, and a loop's values stay fixed.
+static void resolve_variations(iam_instance_data* inst, iam_clip_data const* clip) {
+	if (clip->var_value_count == 0) return;
+	if (inst->var_layout == clip->key_version && inst->var_loop == inst->current_loop) return;
+	inst->var_keys.resize(clip->var_value_count);
+	resolve_variation_keys(clip, inst->current_loop, &inst->var_rng_state, inst->var_keys.Data);
+	inst->var_loop = inst->current_loop;
+	inst->var_layout = clip->key_version;
 }
 
-} // namespace iam_clip_detail
-
-// ----------------------------------------------------
+// Eased interpolation weight between two bracketing keys at time t
+static float segment_weight(iam_track const& trk, keyframe const* k0, keyframe const* k1, float t) {
+	float u = (k1->time == k0->time) ? 1.0f : (t - k0->time) / (k1->time - k0->time);
+	if (k0->is_spring && trk.type == iam_chan_float)
+		return eval_clip_spring(u, k0->spring);
+	return eval_clip_ease(k0->ease_type, u, k0->bezier, k0->has_bezier);
+}
+
+// Evaluate a baked track: clamp to the table, then lerp the two neighbouring samples
+static void eval_baked_track(iam_track const& trk, float t, float* dst) {
+	int n = track_value_size(trk.type);
+	float x = (t - trk.bake_t0) * trk.bake_rate;
+	int i = 0;
+	float f = 0.0f;
+	if (x >= (float)(trk.bake_count - 1)) {
+		i = trk.bake_count - 1;
+	} else if (x > 0.0f) {
+		i = (int)x;
+		f = x - (float)i;
+	}
+	float const* a = trk.baked.Data + i * n;
+	if (f == 0.0f) {
+		memcpy(dst, a, sizeof(float) * n);
+	} else {
+		float const* b = a + n;
+		for (int c = 0; c < n; ++c)
+			dst[c] = a[c] + (b[c] - a[c]) * f;
+	}
+	if (trk.type == iam_chan_int) {
+		int v = (int)ImFloor(dst[0] + 0.5f);
+		memcpy(dst, &v, sizeof(int));
+	}
+}
+
+// Evaluate a packed track straight from the pack memory (binary search over the time column)
+static void eval_packed_track(iam_track const& trk, float t, float* dst) {
+	int count = trk.packed_count;
+	int n = track_value_size(trk.type);
+	float const* times = trk.packed_times;
+	int i0 = 0, i1 = 0;
+	if (count > 1 && t > times[0]) {
+		if (t >= times[count - 1]) {
+			i0 = i1 = count - 1;
+		} else {
+			int lo = 0, hi = count - 1;
+			while (hi - lo > 1) {
+				int mid = (lo + hi) >> 1;
+				if (times[mid] <= t) lo = mid; else hi = mid;
+			}
+			i0 = lo;
+			i1 = hi;
+		}
+	}
+	float const* a = trk.packed_values + i0 * n;
+	float const* b = trk.packed_values + i1 * n;
+	float w = 1.0f;
+	if (i0 != i1) {
+		float u = (times[i1] == times[i0]) ? 1.0f : (t - times[i0]) / (times[i1] - times[i0]);
+		int flags = trk.packed_flags[i0];
+		float const* params = trk.packed_params + i0 * 4;
+		if ((flags & PACK_KEY_SPRING) && trk.type == iam_chan_float) {
+			iam_spring_params sp = { params[0], params[1], params[2], params[3] };
+			w = eval_clip_spring(u, sp);
+		} else {
+			w = eval_clip_ease(trk.packed_eases[i0], u, params, (flags & PACK_KEY_BEZIER) != 0);
+		}
+	}
+	switch (trk.type) {
+		case iam_chan_int: {
+			int ia, ib;
+			memcpy(&ia, a, sizeof(int));
+			memcpy(&ib, b, sizeof(int));
+			int v = (int)(ia + (int)((float)(ib - ia) * w + 0.5f));
+			memcpy(dst, &v, sizeof(int));
+			break;
+		}
+		case iam_chan_color: {
+			ImVec4 v = iam_detail::color::lerp_color(ImVec4(a[0], a[1], a[2], a[3]), ImVec4(b[0], b[1], b[2], b[3]), w, trk.color_space);
+			dst[0] = v.x; dst[1] = v.y; dst[2] = v.z; dst[3] = v.w;
+			break;
+		}
+		default:
+			for (int c = 0; c < n; ++c)
+				dst[c] = a[c] + (b[c] - a[c]) * w;
+			break;
+	}
+}
+
+// Evaluate a track at time t into dst (track_value_size floats). var_keys is the resolved variation
+// cache for the clip (only read for tracks with variation).
+static void eval_track_into(iam_track const& trk, float t, float const* var_keys, float* dst) {
+	if (trk.packed_count > 0) {
+		eval_packed_track(trk, t, dst);
+		return;
+	}
+	if (trk.keys.Size == 0) return;
+	if (trk.bake_count > 0) {
+		eval_baked_track(trk, t, dst);
+		return;
+	}
+	keyframe const* k0; keyframe const* k1;
+	if (!find_keys(trk, t, &k0, &k1)) return;
+	if (!k0 || !k1) return;  // Safety check
+
+	float w = segment_weight(trk, k0, k1, t);
+
+	// Key values: the varied copies for this loop when the track has variation (see resolve_variations)
+	float const* a = k0->value;
+	float const* b = k1->value;
+	if (trk.var_offset >= 0) {
+		int n = track_value_size(trk.type);
+		float const* keys = var_keys + trk.var_offset;
+		a = keys + (int)(k0 - trk.keys.Data) * n;
+		b = keys + (int)(k1 - trk.keys.Data) * n;
+	}
+
+	switch (trk.type) {
+		case iam_chan_float:
+			dst[0] = a[0] + (b[0] - a[0]) * w;
+			break;
+		case iam_chan_vec2:
+			dst[0] = a[0] + (b[0] - a[0]) * w;
+			dst[1] = a[1] + (b[1] - a[1]) * w;
+			break;
+		case iam_chan_vec4:
+			dst[0] = a[0] + (b[0] - a[0]) * w;
+			dst[1] = a[1] + (b[1] - a[1]) * w;
+			dst[2] = a[2] + (b[2] - a[2]) * w;
+			dst[3] = a[3] + (b[3] - a[3]) * w;
+			break;
+		case iam_chan_int: {
+			int ia, ib;
+			memcpy(&ia, a, sizeof(int));
+			memcpy(&ib, b, sizeof(int));
+			int v = (int)(ia + (int)((float)(ib - ia) * w + 0.5f));
+			memcpy(dst, &v, sizeof(int));
+			break;
+		}
+		case iam_chan_color: {
+			// Blend in the specified color space
+			ImVec4 v = iam_detail::color::lerp_color(ImVec4(a[0], a[1], a[2], a[3]), ImVec4(b[0], b[1], b[2], b[3]), w, trk.color_space);
+			dst[0] = v.x; dst[1] = v.y; dst[2] = v.z; dst[3] = v.w;
+			break;
+		}
+		case iam_chan_float_rel:
+		case iam_chan_vec2_rel:
+		case iam_chan_vec4_rel:
+		case iam_chan_color_rel: {
+			// Interpolate percent and px_bias separately; resolved against the anchor at get time.
+			// Layout matches the keyframe: float/vec2 pack percent+bias in value[], vec4/color spill bias into value_ext[].
+			int n = track_value_size(trk.type);
+			int nv = n > 4 ? 4 : n;
+			for (int c = 0; c < nv; ++c)
+				dst[c] = k0->value[c] + (k1->value[c] - k0->value[c]) * w;
+			for (int c = nv; c < n; ++c)
+				dst[c] = k0->value_ext[c - 4] + (k1->value_ext[c - 4] - k0->value_ext[c - 4]) * w;
+			break;
+		}
+	}
+}
+
+static void eval_iam_track(iam_track const& trk, float t, iam_instance_data* inst) {
+	if (!inst) return;
+	eval_track_into(trk, t, inst->var_keys.Data, inst->values.Data + trk.value_offset);
+}
+
+// ----------------------------------------------------
+// Baking - uniform sample tables per track
+// ----------------------------------------------------
+
+// Drop all baked tables of a clip (evaluation goes back to live keyframes)
+static void unbake_clip(iam_clip_data* clip) {
+	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
+		iam_track& trk = clip->iam_tracks[tr];
+		trk.baked.clear();
+		trk.bake_count = 0;
+		trk.bake_rate = 0.0f;
+	}
+	clip->bake_rate = 0.0f;
+	clip->bake_bytes = 0;
+	clip->bake_max_error = 0.0f;
+}
+
+// Sample one track live at sample_rate between its first and last key, then measure the error of the
+// baked lerp against live evaluation halfway between samples. Returns the track's max error.
+// Relative tracks (anchor dependent) and tracks with variations stay live.
+// scratch must be bound to the clip's value layout.
+static float bake_track(iam_track& trk, float sample_rate, iam_instance_data* scratch) {
+	trk.baked.clear();
+	trk.bake_count = 0;
+	trk.bake_rate = 0.0f;
+	if (trk.is_relative || trk.var_offset >= 0 || trk.keys.Size < 2) return 0.0f;
+	float max_error = 0.0f;
+	float live[8], baked[8];
+	float t0 = trk.keys[0].time;
+	float span = trk.keys[trk.keys.Size - 1].time - t0;
+	int n = track_value_size(trk.type);
+	int intervals = (int)(span * sample_rate);
+	if ((float)intervals < span * sample_rate) intervals++;
+	int count = intervals < 1 ? 2 : intervals + 1;
+	float step = span / (float)(count - 1);
+	trk.baked.resize(count * n);
+	float* dst = scratch->values.Data + trk.value_offset;
+	for (int i = 0; i < count; ++i) {
+		eval_iam_track(trk, t0 + step * (float)i, scratch);
+		float* out = trk.baked.Data + i * n;
+		if (trk.type == iam_chan_int) { int v; memcpy(&v, dst, sizeof(int)); out[0] = (float)v; }
+		else memcpy(out, dst, sizeof(float) * n);
+	}
+	for (int i = 0; i + 1 < count; ++i) {
+		float t = t0 + step * ((float)i + 0.5f);
+		eval_iam_track(trk, t, scratch);
+		memcpy(live, dst, sizeof(float) * n);
+		trk.bake_t0 = t0;
+		trk.bake_rate = step > 0.0f ? 1.0f / step : 0.0f;
+		trk.bake_count = count;
+		eval_iam_track(trk, t, scratch);
+		memcpy(baked, dst, sizeof(float) * n);
+		trk.bake_count = 0;
+		if (trk.type == iam_chan_int) {
+			int a, b;
+			memcpy(&a, baked, sizeof(int));
+			memcpy(&b, live, sizeof(int));
+			baked[0] = (float)a;
+			live[0] = (float)b;
+		}
+		for (int c = 0; c < n; ++c) {
+			float e = ImFabs(baked[c] - live[c]);
+			if (e > max_error) max_error = e;
+		}
+	}
+	trk.bake_t0 = t0;
+	trk.bake_rate = step > 0.0f ? 1.0f / step : 0.0f;
+	trk.bake_count = count;
+	return max_error;
+}
+
+static void bake_clip(iam_clip_data* clip, float sample_rate) {
+	unbake_clip(clip);
+	iam_instance_data scratch;
+	bind_instance_values(&scratch, clip);
+	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
+		iam_track& trk = clip->iam_tracks[tr];
+		float e = bake_track(trk, sample_rate, &scratch);
+		if (e > clip->bake_max_error) clip->bake_max_error = e;
+		clip->bake_bytes += trk.baked.Size * (int)sizeof(float);
+	}
+	clip->bake_rate = sample_rate;
+}
+
+// ----------------------------------------------------
+// Keyframe reduction - merge runs of keys into single eased segments within a tolerance
+// ----------------------------------------------------
+
+static int const OPT_SAMPLES_PER_SEGMENT = 4;	// Reference samples per original segment (key time included)
+static int const OPT_MAX_RUN = 64;				// Most original segments merged into one (keeps the fit linear in key count)
+
+// Eases tried when a run of segments is merged into one, after the first key's own ease
+static int const s_opt_eases[] = {
+	iam_ease_linear,
+	iam_ease_in_quad,  iam_ease_out_quad,  iam_ease_in_out_quad,
+	iam_ease_in_cubic, iam_ease_out_cubic, iam_ease_in_out_cubic,
+	iam_ease_in_quart, iam_ease_out_quart, iam_ease_in_out_quart,
+	iam_ease_in_quint, iam_ease_out_quint, iam_ease_in_out_quint,
+	iam_ease_in_sine,  iam_ease_out_sine,  iam_ease_in_out_sine,
+	iam_ease_in_expo,  iam_ease_out_expo,  iam_ease_in_out_expo,
+	iam_ease_in_circ,  iam_ease_out_circ,  iam_ease_in_out_circ,
+};
+
+// Springs, variations and stepped int tracks are left as authored
+static bool track_is_optimizable(iam_track const& trk) {
+	if (trk.type == iam_chan_int || trk.keys.Size < 3) return false;
+	for (int k = 0; k < trk.keys.Size; ++k)
+		if (trk.keys[k].is_spring || trk.keys[k].has_variation) return false;
+	return true;
+}
+
+// Max difference between the fit track (one segment, scratch slot 8) and the reference samples over segments [a, c).
+// Stops as soon as it exceeds limit: the result is then only known to be above it.
+static float segment_fit_error(iam_track const& src, int a, int c, ImVector<float> const& ref, iam_track const& fit, iam_instance_data* scratch, float limit) {
+	int n = track_value_size(src.type);
+	float max_err = 0.0f;
+	for (int j = a; j < c; ++j) {
+		float t0 = src.keys[j].time, t1 = src.keys[j + 1].time;
+		for (int sidx = 0; sidx < OPT_SAMPLES_PER_SEGMENT; ++sidx) {
+			float t = t0 + (t1 - t0) * (float)sidx / (float)OPT_SAMPLES_PER_SEGMENT;
+			eval_iam_track(fit, t, scratch);
+			float const* r = ref.Data + (j * OPT_SAMPLES_PER_SEGMENT + sidx) * n;
+			for (int comp = 0; comp < n; ++comp) {
+				float e = ImFabs(scratch->values[8 + comp] - r[comp]);
+				if (e > max_err) max_err = e;
+			}
+			if (max_err > limit) return max_err;
+		}
+	}
+	return max_err;
+}
+
+// Greedily extend each segment over as many following keys as one ease can reproduce within tolerance
+static void optimize_track(iam_track& trk, float tolerance, iam_instance_data* scratch) {
+	int n = track_value_size(trk.type);
+	int count = trk.keys.Size;
+
+	// Reference samples of the original curve
+	iam_track ref_trk;
+	ref_trk.type = trk.type;
+	ref_trk.color_space = trk.color_space;
+	ref_trk.keys = trk.keys;
+	ref_trk.value_offset = 0;
+	ImVector<float> ref;
+	ref.resize((count - 1) * OPT_SAMPLES_PER_SEGMENT * n);
+	for (int j = 0; j + 1 < count; ++j) {
+		float t0 = trk.keys[j].time, t1 = trk.keys[j + 1].time;
+		for (int sidx = 0; sidx < OPT_SAMPLES_PER_SEGMENT; ++sidx) {
+			eval_iam_track(ref_trk, t0 + (t1 - t0) * (float)sidx / (float)OPT_SAMPLES_PER_SEGMENT, scratch);
+			memcpy(ref.Data + (j * OPT_SAMPLES_PER_SEGMENT + sidx) * n, scratch->values.Data, sizeof(float) * n);
+		}
+	}
+
+	iam_track fit;
+	fit.type = trk.type;
+	fit.color_space = trk.color_space;
+	fit.value_offset = 8;
+	fit.keys.resize(2);
+
+	ImVector<keyframe> out;
+	out.push_back(trk.keys[0]);
+	int a = 0;
+	while (a < count - 1) {
+		int best_c = a + 1;
+		keyframe best_key = trk.keys[a];
+		for (int c = a + 2; c < count && c - a <= OPT_MAX_RUN; ++c) {
+			if (trk.keys[c].time <= trk.keys[a].time) break;
+			fit.keys[1] = trk.keys[c];
+			float best_err = FLT_MAX;
+			keyframe cand_best;
+			for (int e = -1; e < IM_ARRAYSIZE(s_opt_eases); ++e) {
+				fit.keys[0] = trk.keys[a];
+				if (e >= 0) {
+					if (s_opt_eases[e] == trk.keys[a].ease_type && !trk.keys[a].has_bezier) continue;
+					fit.keys[0].ease_type = s_opt_eases[e];
+					fit.keys[0].has_bezier = false;
+				}
+				float err = segment_fit_error(trk, a, c, ref, fit, scratch, ImMin(best_err, tolerance));
+				if (err < best_err) {
+					best_err = err;
+					cand_best = fit.keys[0];
+				}
+			}
+			if (best_err > tolerance) break;
+			best_c = c;
+			best_key = cand_best;
+		}
+		out.back() = best_key;
+		out.push_back(trk.keys[best_c]);
+		a = best_c;
+	}
+	trk.keys.swap(out);
+}
+
+// Bring the instance value block to time t. Evaluates every track now, or in lazy mode
+// only records t so each track is evaluated the first time it is read (see track_values).
+static void eval_instance_tracks(iam_clip_data const* clip, float t, iam_instance_data* inst) {
+	inst->budget_due = false;
+	bind_instance_values(inst, clip);
+	resolve_variations(inst, clip);
+
+	// Instances of a clip without variations at the same (quantized) time share one evaluated block.
+	// Serial phases only: the cache is global and not guarded for worker threads.
+	ImGuiID cache_key = 0;
+	if (g_clip_sys.eval_cache && !g_clip_sys.lazy_eval && !inst->culled && !g_clip_sys.in_parallel && clip->var_value_count == 0 && clip->value_count > 0) {
+		float q = g_clip_sys.eval_cache_quantum;
+		if (q > 0.0f) t = ImFloor(t / q + 0.5f) * q;
+		cache_key = ImHashData(&t, sizeof(t), ImHashData(&clip->key_version, sizeof(clip->key_version)));
+		int idx = g_clip_sys.eval_cache_index.GetInt(cache_key, 0) - 1;
+		iam_eval_cache_entry const* entry = idx >= 0 ? &g_clip_sys.eval_cache_entries[idx] : nullptr;
+		if (entry && entry->key_version == clip->key_version && entry->time == t && entry->value_count == clip->value_count) {  // A hash collision is a miss
+			memcpy(inst->values.Data, g_clip_sys.eval_cache_values.Data + entry->offset, sizeof(float) * clip->value_count);
+			inst->eval_time = t;
+			inst->eval_serial++;
+			inst->eval_all_serial = inst->eval_serial;
+			g_clip_sys.stat_cache_hits++;
+			return;
+		}
+		g_clip_sys.stat_cache_misses++;
+	}
+
+	inst->eval_time = t;
+	inst->eval_serial++;
+	if (g_clip_sys.lazy_eval || inst->culled) {
+		inst->frame_tracks_deferred += clip->iam_tracks.Size;
+		return;
+	}
+	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
+		eval_iam_track(clip->iam_tracks[tr], t, inst);
+	}
+	inst->eval_all_serial = inst->eval_serial;
+	inst->frame_tracks_evaluated += clip->iam_tracks.Size;
+
+	if (cache_key != 0) {
+		iam_eval_cache_entry entry;
+		entry.key_version = clip->key_version;
+		entry.time = t;
+		entry.value_count = clip->value_count;
+		entry.offset = g_clip_sys.eval_cache_values.Size;
+		g_clip_sys.eval_cache_values.resize(entry.offset + clip->value_count);
+		memcpy(g_clip_sys.eval_cache_values.Data + entry.offset, inst->values.Data, sizeof(float) * clip->value_count);
+		g_clip_sys.eval_cache_entries.push_back(entry);
+		g_clip_sys.eval_cache_index.SetInt(cache_key, g_clip_sys.eval_cache_entries.Size);
+	}
+}
+
+// Current values of one track, evaluating it first if it is stale (memoized until the next eval_instance_tracks)
+static float const* track_values(iam_instance_data* inst, iam_clip_data const* clip, int track_index) {
+	iam_track const& trk = clip->iam_tracks[track_index];
+	if (inst->eval_all_serial != inst->eval_serial && inst->track_serial[track_index] != inst->eval_serial) {
+		eval_iam_track(trk, inst->eval_time, inst);
+		inst->track_serial[track_index] = inst->eval_serial;
+		if (g_clip_sys.in_parallel) {
+			inst->frame_tracks_evaluated++;  // Summed at dispatch: workers never touch the global counters
+			inst->frame_tracks_lazy++;
+		} else {
+			g_clip_sys.stat_tracks_evaluated++;
+			g_clip_sys.stat_tracks_lazy++;
+		}
+	}
+	return inst->values.Data + trk.value_offset;
+}
+
+// ----------------------------------------------------
+// Instanced playback - N lanes of one clip in a single instance
+// ----------------------------------------------------
+
+// Per-lane clip time from the shared clock. Closed form so every lane is independent:
+// lane l is (clock - l * stagger) into its own playback, with looping and direction applied per lane.
+// Returns true once every lane has finished.
+static bool compute_lane_times(iam_clip_data const* clip, iam_instance_data* inst) {
+	int n = inst->lane_count;
+	float dur = clip->duration;
+	int cycles = (clip->loop_count < 0) ? -1 : clip->loop_count + 1;
+	float total = (cycles < 0) ? FLT_MAX : dur * (float)cycles;
+	bool all_done = true;
+	for (int l = 0; l < n; ++l) {
+		float local = inst->lane_clock - inst->lane_stagger * (float)l;
+		if (local < 0.0f) local = 0.0f;
+		if (local >= total) local = total;
+		else all_done = false;
+		float t = 0.0f;
+		if (dur > 0.0f) {
+			int cycle = (int)(local / dur);
+			if (cycles > 0 && cycle >= cycles) cycle = cycles - 1;  // End of the last cycle
+			float frac = local - dur * (float)cycle;
+			if (frac > dur) frac = dur;
+			if (clip->direction == iam_dir_reverse) t = dur - frac;
+			else if (clip->direction == iam_dir_alternate && (cycle & 1)) t = dur - frac;
+			else t = frac;
+		}
+		inst->lane_time[l] = t;
+	}
+	return all_done;
+}
+
+// Evaluate every track for all lanes. Staggered lanes sit at neighbouring times, so each track keeps a
+// key cursor that only steps between adjacent segments instead of searching per lane.
+// Lanes use base key values (no per-loop variation); int lanes hold the rounded value as float.
+// Lane 0 also fills the instance value block.
+static void eval_instance_lanes(iam_clip_data const* clip, iam_instance_data* inst) {
+	int n = inst->lane_count;
+	if (inst->lane_values.Size != clip->value_count * n) {
+		inst->lane_values.resize(clip->value_count * n);
+		if (inst->lane_values.Size > 0) memset(inst->lane_values.Data, 0, sizeof(float) * inst->lane_values.Size);
+	}
+	float const* lane_t = inst->lane_time.Data;
+	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
+		iam_track const& trk = clip->iam_tracks[tr];
+		int key_count = trk.keys.Size;
+		if (key_count == 0) continue;
+		keyframe const* keys = trk.keys.Data;
+		float first = keys[0].time, last = keys[key_count - 1].time;
+		int comps = track_value_size(trk.type);
+		int nv = comps > 4 ? 4 : comps;
+		float* out = inst->lane_values.Data + trk.value_offset * n;
+		int seg = 0;
+		for (int l = 0; l < n; ++l) {
+			float t = lane_t[l];
+			keyframe const* k0; keyframe const* k1;
+			if (key_count == 1 || t <= first) {
+				k0 = k1 = &keys[0];
+			} else if (t >= last) {
+				k0 = k1 = &keys[key_count - 1];
+			} else {
+				while (seg > 0 && t < keys[seg].time) seg--;
+				while (seg < key_count - 2 && t > keys[seg + 1].time) seg++;
+				k0 = &keys[seg];
+				k1 = &keys[seg + 1];
+			}
+			float w = segment_weight(trk, k0, k1, t);
+			if (trk.type == iam_chan_color) {
+				ImVec4 v = iam_detail::color::lerp_color(k0->get_color(), k1->get_color(), w, trk.color_space);
+				out[0 * n + l] = v.x; out[1 * n + l] = v.y; out[2 * n + l] = v.z; out[3 * n + l] = v.w;
+			} else if (trk.type == iam_chan_int) {
+				int a = k0->get_int(), b = k1->get_int();
+				out[l] = (float)(a + (int)((float)(b - a) * w + 0.5f));
+			} else {
+				for (int c = 0; c < nv; ++c)
+					out[c * n + l] = k0->value[c] + (k1->value[c] - k0->value[c]) * w;
+				for (int c = nv; c < comps; ++c)
+					out[c * n + l] = k0->value_ext[c - 4] + (k1->value_ext[c - 4] - k0->value_ext[c - 4]) * w;
+			}
+		}
+	}
+
+	// Lane 0 is the regular value block, so get_* reads it without a second evaluation
+	bind_instance_values(inst, clip);
+	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
+		iam_track const& trk = clip->iam_tracks[tr];
+		float const* lane0 = inst->lane_values.Data + trk.value_offset * n;
+		float* dst = inst->values.Data + trk.value_offset;
+		if (trk.type == iam_chan_int) {
+			int v = (int)lane0[0];
+			memcpy(dst, &v, sizeof(int));
+		} else {
+			for (int c = 0, comps = track_value_size(trk.type); c < comps; ++c)
+				dst[c] = lane0[c * n];
+		}
+	}
+	inst->eval_time = inst->lane_time[0];
+	inst->eval_serial++;
+	inst->eval_all_serial = inst->eval_serial;
+}
+
+// Build the bezier LUTs a clip uses up front: the LUT cache is not thread-safe and
+// track evaluation may run on worker threads (iam_clip_set_parallel_for)
+static void prewarm_clip_luts(iam_clip_data const* clip) {
+	for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+		iam_track const& trk = clip->iam_tracks[t];
+		for (int k = 0; k < trk.keys.Size; ++k) {
+			keyframe const& key = trk.keys[k];
+			if (key.has_bezier && key.ease_type == iam_ease_cubic_bezier)
+				eval_clip_ease(key.ease_type, 0.0f, key.bezier, true);
+		}
+		for (int k = 0; k < trk.packed_count; ++k) {
+			if ((trk.packed_flags[k] & PACK_KEY_BEZIER) && trk.packed_eases[k] == iam_ease_cubic_bezier)
+				eval_clip_ease(trk.packed_eases[k], 0.0f, trk.packed_params + k * 4, true);
+		}
+	}
+}
+
+// Evaluate any tracks still pending from lazy mode (for consumers that read the whole block)
+static void resolve_instance_tracks(iam_instance_data* inst, iam_clip_data const* clip) {
+	if (inst->eval_all_serial == inst->eval_serial) return;
+	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr)
+		track_values(inst, clip, tr);
+	inst->eval_all_serial = inst->eval_serial;
+}
+
+// Evaluate an instance in the advance phase. Under a fixed tick rate this only happens on ticks, and the
+// values being replaced are kept so reads can interpolate from them.
+static void eval_instance_tick(iam_clip_data const* clip, float t, iam_instance_data* inst) {
+	if (g_clip_sys.tick_interval <= 0.0f || inst->realtime || inst->culled) {
+		eval_instance_tracks(clip, t, inst);
+		return;
+	}
+	if (!g_clip_sys.tick_due) return;
+	inst->tick_prev_layout = 0;
+	if (inst->values_layout == clip->layout_version && clip->value_count > 0) {
+		// Lazy mode: only tracks evaluated since the last tick are kept, the rest are not forced
+		bool all = inst->eval_all_serial == inst->eval_serial;
+		inst->tick_prev.resize(clip->value_count);
+		inst->tick_prev_valid.resize(clip->iam_tracks.Size);
+		if (all) {
+			memcpy(inst->tick_prev.Data, inst->values.Data, sizeof(float) * clip->value_count);
+			memset(inst->tick_prev_valid.Data, 1, (size_t)clip->iam_tracks.Size);
+		} else {
+			for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
+				iam_track const& trk = clip->iam_tracks[tr];
+				bool fresh = inst->track_serial[tr] == inst->eval_serial;
+				inst->tick_prev_valid[tr] = fresh ? 1 : 0;
+				if (fresh) memcpy(inst->tick_prev.Data + trk.value_offset, inst->values.Data + trk.value_offset, sizeof(float) * track_value_size(trk.type));
+			}
+		}
+		inst->tick_prev_layout = inst->values_layout;
+	}
+	eval_instance_tracks(clip, t, inst);
+	inst->tick_serial = g_clip_sys.tick_serial;
+}
+
+// Evaluate an instance in the advance phase, or under an update budget, queue it for the scheduler
+// (run_budget_scheduler). Culled instances and updates between ticks have nothing to schedule.
+static void schedule_eval(iam_clip_data const* clip, float t, iam_instance_data* inst) {
+	if (g_clip_sys.budget_us > 0.0f && !inst->culled &&
+		(g_clip_sys.tick_interval <= 0.0f || inst->realtime || g_clip_sys.tick_due)) {
+		inst->budget_due = true;
+		inst->budget_time = t;
+		return;
+	}
+	eval_instance_tick(clip, t, inst);
+}
+
+// Values of one track as seen by reads: the current values, or between ticks, the previous tick's values
+// blended toward them. scratch holds up to 8 floats.
+static float const* track_read_values(iam_instance_data* inst, iam_clip_data const* clip, int track_index, float* scratch) {
+	float const* cur = track_values(inst, clip, track_index);
+	if (g_clip_sys.tick_interval <= 0.0f || inst->realtime || inst->tick_serial != g_clip_sys.tick_serial ||
+		inst->tick_prev_layout != inst->values_layout || g_clip_sys.tick_alpha >= 1.0f || !inst->tick_prev_valid[track_index])
+		return cur;
+	iam_track const& trk = clip->iam_tracks[track_index];
+	float const* prev = inst->tick_prev.Data + trk.value_offset;
+	float a = g_clip_sys.tick_alpha;
+	if (trk.type == iam_chan_int) {
+		int ia, ib;
+		memcpy(&ia, prev, sizeof(int));
+		memcpy(&ib, cur, sizeof(int));
+		int v = ia + (int)ImFloor((float)(ib - ia) * a + 0.5f);
+		memcpy(scratch, &v, sizeof(int));
+	} else {
+		for (int c = 0, n = track_value_size(trk.type); c < n; ++c)
+			scratch[c] = prev[c] + (cur[c] - prev[c]) * a;
+	}
+	return scratch;
+}
+
+// First marker at or after time (clip markers are sorted by time)
+static int marker_lower_bound(iam_clip_data const* clip, float time) {
+	int lo = 0, hi = clip->markers.Size;
+	while (lo < hi) {
+		int mid = (lo + hi) >> 1;
+		if (clip->markers[mid].time < time) lo = mid + 1; else hi = mid;
+	}
+	return lo;
+}
+
+// First marker after time
+static int marker_upper_bound(iam_clip_data const* clip, float time) {
+	int lo = 0, hi = clip->markers.Size;
+	while (lo < hi) {
+		int mid = (lo + hi) >> 1;
+		if (clip->markers[mid].time <= time) lo = mid + 1; else hi = mid;
+	}
+	return lo;
+}
+
+// Place the marker cursor so markers at time and beyond (in the playing direction) are still to be crossed
+static void place_marker_cursor(iam_instance_data* inst, iam_clip_data const* clip, float time) {
+	inst->marker_cursor = (inst->dir_sign > 0) ? marker_lower_bound(clip, time) : marker_upper_bound(clip, time);
+	inst->marker_layout = clip->layout_version;
+}
+
+// Advance the marker cursor up to time in direction dir, queuing the markers crossed. Markers without a
+// callback are only queued for the event queue.
+static void queue_crossed_markers(iam_instance_data* inst, iam_clip_data const* clip, float time, int dir) {
+	bool events = g_clip_sys.events.data != nullptr || g_clip_sys.task_marker_waits.Size > 0;  // Queue every marker
+	iam_marker const* markers = clip->markers.Data;
+	int cursor = inst->marker_cursor;
+	if (dir > 0) {
+		for (; cursor < clip->markers.Size && markers[cursor].time <= time; ++cursor)
+			if (markers[cursor].callback || events) inst->pending_markers.push_back(cursor);
+	} else {
+		for (; cursor > 0 && markers[cursor - 1].time >= time; --cursor)
+			if (markers[cursor - 1].callback || events) inst->pending_markers.push_back(cursor - 1);
+	}
+	inst->marker_cursor = cursor;
+}
+
+// Build ordering: iam_clip::end groups keys into tracks by (channel, type) hash, then stable-sorts each
+// track's keys by time, and the tracks by their first key.
+// Bottom-up merge sort: O(n log n) and stable, so keys and markers sharing a time keep authoring order.
+// Elements are relocated bytewise (like ImVector), so types owning ImVectors can be sorted too.
+template<typename T, typename Less>
+static void stable_sort(T* data, int count, Less less) {
+	if (count < 2) return;
+	ImVector<T> tmp;
+	tmp.resize(count);
+	T* src = data;
+	T* dst = tmp.Data;
+	for (int width = 1; width < count; width *= 2) {
+		for (int lo = 0; lo < count; lo += 2 * width) {
+			int mid = ImMin(lo + width, count), hi = ImMin(lo + 2 * width, count);
+			int i = lo, j = mid, o = lo;
+			while (i < mid && j < hi) memcpy((void*)&dst[o++], (void const*)(less(src[j], src[i]) ? &src[j++] : &src[i++]), sizeof(T));
+			while (i < mid) memcpy((void*)&dst[o++], (void const*)&src[i++], sizeof(T));
+			while (j < hi) memcpy((void*)&dst[o++], (void const*)&src[j++], sizeof(T));
+		}
+		T* swap = src; src = dst; dst = swap;
+	}
+	if (src != data) memcpy((void*)data, (void const*)src, sizeof(T) * (size_t)count);
+}
+
+static bool key_time_less(keyframe const& a, keyframe const& b) { return a.time < b.time; }
+static bool marker_time_less(iam_marker const& a, iam_marker const& b) { return a.time < b.time; }
+static bool track_start_less(iam_track const& a, iam_track const& b) { return a.keys[0].time < b.keys[0].time; }
+
+static ImGuiID track_hash(ImGuiID channel, int type) { return ImHashData(&type, sizeof(type), channel); }
+
+} // namespace iam_clip_detail
+
+// ----------------------------------------------------
 // iam_clip class implementation
 // ----------------------------------------------------
 
@@ -2251,7 +3601,7 @@ static iam_clip_data* get_clip_data(ImGuiID clip_id) {
 	return find_clip(clip_id);
 }
 
-iam_clip iam_clip::begin(ImGuiID clip_id) {
+iam_clip iam_clip::begin(ImGuiID clip_id, int key_count_hint) {
 	using namespace iam_clip_detail;
 	if (!g_clip_sys.initialized) {
 		iam_clip_init();
@@ -2270,8 +3620,15 @@ iam_clip iam_clip::begin(ImGuiID clip_id) {
 	}
 
 	// Reset for building
+	library_forget_clip(clip);  // Redefined clips are no longer streamed or evicted
 	clip->build_keys.clear();
+	if (key_count_hint > 0) clip->build_keys.reserve(key_count_hint);
+	for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+		clip->iam_tracks[t].keys.clear();
+		clip->iam_tracks[t].baked.clear();
+	}
 	clip->iam_tracks.clear();
+	build_channel_index(clip);
 	clip->group_stack.clear();
 	clip->duration = 0;
 	clip->delay = 0;
@@ -2324,6 +3681,23 @@ iam_clip& iam_clip::key_float(ImGuiID channel, float time, float value, int ease
 	return *this;
 }
 
+iam_clip& iam_clip::key_float_array(ImGuiID channel, float const* times, float const* values, int count, int ease_type) {
+	iam_clip_data* clip = get_clip_data(m_clip_id);
+	if (!clip || !times || !values || count <= 0) return *this;
+	clip->build_keys.reserve(clip->build_keys.Size + count);
+	iam_clip_detail::keyframe k;
+	k.channel = channel;
+	k.type = iam_chan_float;
+	k.ease_type = ease_type;
+	for (int i = 0; i < count; ++i) {
+		k.time = compute_key_time(clip, times[i]);
+		k.set_float(values[i]);
+		clip->build_keys.push_back(k);
+		if (k.time > clip->duration) clip->duration = k.time;
+	}
+	return *this;
+}
+
 iam_clip& iam_clip::key_vec2(ImGuiID channel, float time, ImVec2 value, int ease_type, float const* bezier4) {
 	iam_clip_data* clip = get_clip_data(m_clip_id);
 	if (!clip) return *this;
@@ -2766,28 +4140,29 @@ void iam_clip::end() {
 	if (!clip) return;
 	using namespace iam_clip_detail;
 
-	// Sort keyframes by time
-	if (clip->build_keys.Size > 1) {
-		qsort(clip->build_keys.Data, clip->build_keys.Size, sizeof(keyframe), cmp_keyframe);
-	}
-
-	// Build iam_tracks by grouping keyframes by (channel, type)
+	// Group keyframes by (channel, type) through a hash; pass one creates tracks and counts their keys
+	ImGuiStorage track_map;
+	ImVector<int> key_track;
+	ImVector<int> track_keys;
+	key_track.resize(clip->build_keys.Size);
 	for (int i = 0; i < clip->build_keys.Size; ++i) {
 		keyframe const& k = clip->build_keys[i];
-
-		// Find existing iam_track
-		iam_track* trk = nullptr;
-		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
-			if (clip->iam_tracks[t].channel == k.channel && clip->iam_tracks[t].type == k.type) {
-				trk = &clip->iam_tracks[t];
-				break;
-			}
+		ImGuiID h = track_hash(k.channel, k.type);
+		int t = track_map.GetInt(h, 0) - 1;
+		if (t >= 0 && (clip->iam_tracks[t].channel != k.channel || clip->iam_tracks[t].type != k.type)) {
+			// Hash collision: fall back to a scan
+			t = -1;
+			for (int s = 0; s < clip->iam_tracks.Size && t < 0; ++s)
+				if (clip->iam_tracks[s].channel == k.channel && clip->iam_tracks[s].type == k.type) t = s;
 		}
 
 		// Create new iam_track if needed
-		if (!trk) {
+		if (t < 0) {
 			clip->iam_tracks.push_back(iam_track());
-			trk = &clip->iam_tracks.back();
+			t = clip->iam_tracks.Size - 1;
+			if (track_map.GetInt(h, 0) == 0) track_map.SetInt(h, t + 1);
+			track_keys.push_back(0);
+			iam_track* trk = &clip->iam_tracks[t];
 			trk->channel = k.channel;
 			trk->type = k.type;
 			if (k.type == iam_chan_color) {
@@ -2813,95 +4188,247 @@ void iam_clip::end() {
 				trk->anchor_axis = 0;
 			}
 		}
+		key_track[i] = t;
+		track_keys[t]++;
+	}
 
-		trk->keys.push_back(k);
+	// Pass two fills exactly sized tracks, then sorts each by time (skipped when keys were added in order)
+	for (int t = 0; t < clip->iam_tracks.Size; ++t)
+		clip->iam_tracks[t].keys.reserve(track_keys[t]);
+	for (int i = 0; i < clip->build_keys.Size; ++i)
+		clip->iam_tracks[key_track[i]].keys.push_back(clip->build_keys[i]);
+	for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+		ImVector<keyframe>& keys = clip->iam_tracks[t].keys;
+		for (int k = 1; k < keys.Size; ++k) {
+			if (keys[k].time < keys[k - 1].time) {
+				stable_sort(keys.Data, keys.Size, key_time_less);
+				break;
+			}
+		}
 	}
 
+	// Tracks are ordered by their first key, as if created walking keys in time order
+	stable_sort(clip->iam_tracks.Data, clip->iam_tracks.Size, track_start_less);
+
 	// Clear build data
 	clip->build_keys.clear();
 
+	// Index channels and assign value slots so getters never scan tracks
+	build_channel_index(clip);
+	prewarm_clip_luts(clip);
+
 	// Sort markers by time
-	if (clip->markers.Size > 1) {
-		for (int i = 0; i < clip->markers.Size - 1; ++i) {
-			for (int j = i + 1; j < clip->markers.Size; ++j) {
-				if (clip->markers[j].time < clip->markers[i].time) {
-					iam_marker tmp = clip->markers[i];
-					clip->markers[i] = clip->markers[j];
-					clip->markers[j] = tmp;
-				}
-			}
-		}
+	stable_sort(clip->markers.Data, clip->markers.Size, marker_time_less);
+}
+
+namespace iam_clip_detail {
+
+static iam_playlist_data* find_playlist(ImGuiID playlist_id) {
+	int idx = g_clip_sys.playlist_map.GetInt(playlist_id, 0);
+	return idx > 0 ? g_clip_sys.playlists[idx - 1] : nullptr;
+}
+
+// Entry start times, recomputed once any clip has been rebuilt since (missing clips count as empty)
+static void refresh_playlist_starts(iam_playlist_data* pl) {
+	if (pl->start.Size == pl->clips.Size + 1 && pl->start_serial == g_clip_sys.layout_serial) return;
+	pl->start.resize(pl->clips.Size + 1);
+	float t = 0.0f;
+	for (int i = 0; i < pl->clips.Size; ++i) {
+		pl->start[i] = t;
+		iam_clip_data const* clip = find_clip(pl->clips[i]);
+		if (clip) t += ImMax(clip->delay, 0.0f) + ImMax(clip->duration, 0.0f);
+	}
+	pl->start[pl->clips.Size] = t;
+	pl->start_serial = g_clip_sys.layout_serial;
+}
+
+// Point an instance at the start of a playlist entry. Tracks are evaluated by the next advance.
+static void enter_playlist_entry(iam_instance_data* inst, iam_clip_data const* clip) {
+	inst->clip_id = clip->id;
+	inst->delay_left = clip->delay;
+	inst->dir_sign = (clip->direction == iam_dir_reverse) ? -1 : 1;
+	inst->loops_left = 0;
+	inst->time = (inst->dir_sign > 0) ? 0.0f : clip->duration;
+	inst->prev_time = inst->time;
+	place_marker_cursor(inst, clip, inst->prev_time);
+	inst->current_loop = 0;
+	inst->var_loop = -1;
+}
+
+// Move a playlist instance to its next entry; false at the last entry or when the next clip is missing.
+// Runs in the advance phase: the switch is queued for dispatch_instance_events, which fires the callbacks.
+static bool next_playlist_entry(iam_instance_data* inst) {
+	iam_playlist_data const* pl = find_playlist(inst->playlist_id);
+	if (!pl || inst->playlist_index + 1 >= pl->clips.Size) return false;
+	ImGuiID next_id = pl->clips[inst->playlist_index + 1];
+	iam_clip_data const* next = g_clip_sys.in_parallel ? find_registered_clip(next_id) : find_clip(next_id);  // Packed entries: see activate_playlist_clips
+	if (!next) return false;
+	inst->playlist_index++;
+	inst->pending_markers.push_back(-2);
+	enter_playlist_entry(inst, next);
+	return true;
+}
+
+// Activate packed playlist entries before a parallel advance, where next_playlist_entry cannot register clips
+static void activate_playlist_clips() {
+	if (g_clip_sys.packs.Size == 0) return;
+	for (int p = 0; p < g_clip_sys.playlists.Size; ++p) {
+		iam_playlist_data const* pl = g_clip_sys.playlists[p];
+		for (int i = 0; i < pl->clips.Size; ++i)
+			find_clip(pl->clips[i]);
+	}
+}
+
+// Seek a playlist instance to playlist time t: binary search of the entry start times
+static bool seek_playlist(iam_instance_data* inst, float t) {
+	iam_playlist_data* pl = find_playlist(inst->playlist_id);
+	if (!pl || pl->clips.Size == 0) return false;
+	refresh_playlist_starts(pl);
+	float total = pl->start[pl->clips.Size];
+	t = ImClamp(t, 0.0f, total);
+	int lo = 0, hi = pl->clips.Size - 1;  // Last entry starting at or before t
+	while (lo < hi) {
+		int mid = (lo + hi + 1) / 2;
+		if (pl->start[mid] <= t) lo = mid; else hi = mid - 1;
+	}
+	iam_clip_data const* clip = find_clip(pl->clips[lo]);
+	if (!clip) return false;
+	inst->playlist_index = lo;
+	enter_playlist_entry(inst, clip);
+	float local = t - pl->start[lo];
+	float delay = ImMax(clip->delay, 0.0f);
+	if (local < delay) {
+		inst->delay_left = delay - local;
+		return true;
 	}
+	inst->delay_left = 0.0f;
+	float ct = ImMin(local - delay, clip->duration);
+	inst->time = (inst->dir_sign > 0) ? ct : clip->duration - ct;
+	inst->prev_time = inst->time;  // A seek jumps over markers instead of crossing them
+	place_marker_cursor(inst, clip, inst->time);
+	return true;
 }
 
+} // namespace iam_clip_detail
+
 // ----------------------------------------------------
 // iam_instance class implementation
 // ----------------------------------------------------
 
 // Helper to get instance data by ID (safe lookup)
-static iam_instance_data* get_instance_data(ImGuiID inst_id) {
+static iam_instance_data* get_instance_data(ImGuiID inst_id, ImU32 handle) {
 	using namespace iam_clip_detail;
-	return find_instance(inst_id);
+	return find_instance(inst_id, handle);
 }
 
 bool iam_instance::valid() const {
-	return m_inst_id != 0 && get_instance_data(m_inst_id) != nullptr;
+	return m_inst_id != 0 && get_instance_data(m_inst_id, m_handle) != nullptr;
 }
 
 void iam_instance::pause() {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (inst) inst->paused = true;
 }
 
 void iam_instance::resume() {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (inst) inst->paused = false;
 }
 
 void iam_instance::stop() {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
-	if (inst) { inst->playing = false; inst->time = 0; }
+	using namespace iam_clip_detail;
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (!inst) return;
+	inst->playing = false;
+	inst->time = 0;
+	if (g_clip_sys.task_inst_waits.Size > 0) wake_instance_tasks(g_clip_sys.task_inst_waits, inst->inst_id, 0, false);
 }
 
 void iam_instance::destroy() {
 	using namespace iam_clip_detail;
-	int idx = g_clip_sys.inst_map.GetInt(m_inst_id, 0);
-	if (idx == 0) return;
-	// Clear the instance data
-	iam_instance_data* inst = &g_clip_sys.instances[idx - 1];
-	inst->inst_id = 0;
-	inst->clip_id = 0;
-	inst->playing = false;
-	inst->values_float.Clear();
-	inst->values_vec2.clear();
-	inst->values_vec4.clear();
-	inst->values_int.Clear();
-	// Remove from map
-	g_clip_sys.inst_map.SetInt(m_inst_id, 0);
+	iam_instance_data* inst = find_instance(m_inst_id, m_handle);
+	if (!inst) return;
+	free_instance(inst);
 	m_inst_id = 0;
+	m_handle = 0;
 }
 
 void iam_instance::seek(float time) {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (!inst) return;
+	if (inst->playlist_id != 0 && iam_clip_detail::seek_playlist(inst, time)) return;
 	iam_clip_data* clip = get_clip_data(inst->clip_id);
 	if (!clip) return;
 	float dur = clip->duration;
 	if (time < 0) time = 0;
 	if (time > dur) time = dur;
 	inst->time = time;
+	inst->prev_time = time;  // A seek jumps over markers instead of crossing them
+	iam_clip_detail::place_marker_cursor(inst, clip, time);
+	if (inst->lane_count > 0) inst->lane_clock = time;  // Instanced: seek the shared lane clock
+}
+
+int iam_instance::lane_count() const {
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	return inst ? inst->lane_count : 0;
+}
+
+float const* iam_instance::get_lanes(ImGuiID channel, int type, int component) const {
+	using namespace iam_clip_detail;
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (!inst || inst->lane_count == 0) return nullptr;
+	iam_clip_data* clip = find_clip(inst->clip_id);
+	int tr = find_bound_track(inst, clip, channel, track_value_kind(type));
+	if (tr < 0) return nullptr;
+	iam_track const& trk = clip->iam_tracks[tr];
+	if (component < 0 || component >= track_value_size(trk.type)) return nullptr;
+	if (inst->lane_values.Size != clip->value_count * inst->lane_count) return nullptr;
+	return inst->lane_values.Data + (trk.value_offset + component) * inst->lane_count;
 }
 
 void iam_instance::set_time_scale(float scale) {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (inst) inst->time_scale = scale;
 }
 
 void iam_instance::set_weight(float weight) {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (inst) inst->weight = weight;
 }
 
+void iam_instance::set_realtime(bool realtime) {
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (inst) inst->realtime = realtime;
+}
+
+void iam_instance::set_priority(int priority) {
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (inst) inst->priority = priority;
+}
+
+void iam_instance::set_time_domain(ImGuiID domain_id) {
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (inst) inst->time_domain = domain_id != 0 ? iam_detail::g_domain_map.GetInt(domain_id, 0) : 0;
+}
+
+void iam_instance::set_visible(bool visible) {
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (!inst) return;
+	inst->hidden = !visible;
+	inst->cull_rect = false;
+}
+
+void iam_instance::set_cull_rect(ImVec2 min, ImVec2 max) {
+	using namespace iam_clip_detail;
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (!inst) return;
+	ImGuiWindow* window = ImGui::GetCurrentWindowRead();
+	inst->hidden = false;
+	inst->cull_rect = true;
+	inst->cull_visible = window && !window->SkipItems && ImGui::IsRectVisible(min, max);
+	inst->cull_frame = g_clip_sys.frame_counter;
+}
+
 // Animation chaining
 static ImGuiID generate_chain_instance_id() {
 	static unsigned s_chain_counter = 0;
@@ -2909,7 +4436,7 @@ static ImGuiID generate_chain_instance_id() {
 }
 
 iam_instance& iam_instance::then(ImGuiID next_clip_id) {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (inst) {
 		inst->chain_next_clip_id = next_clip_id;
 		inst->chain_next_inst_id = generate_chain_instance_id();  // Auto-generate instance ID
@@ -2918,7 +4445,7 @@ iam_instance& iam_instance::then(ImGuiID next_clip_id) {
 }
 
 iam_instance& iam_instance::then(ImGuiID next_clip_id, ImGuiID next_instance_id) {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (inst) {
 		inst->chain_next_clip_id = next_clip_id;
 		inst->chain_next_inst_id = next_instance_id;
@@ -2927,211 +4454,152 @@ iam_instance& iam_instance::then(ImGuiID next_clip_id, ImGuiID next_instance_id)
 }
 
 iam_instance& iam_instance::then_delay(float delay) {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (inst) {
 		inst->chain_delay = delay;
 	}
 	return *this;
 }
 
+int iam_instance::playlist_index() const {
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	return (inst && inst->playlist_id != 0) ? inst->playlist_index : -1;
+}
+
+float iam_instance::playlist_time() const {
+	using namespace iam_clip_detail;
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (!inst || inst->playlist_id == 0) return 0.0f;
+	iam_playlist_data* pl = find_playlist(inst->playlist_id);
+	iam_clip_data* clip = get_clip_data(inst->clip_id);
+	if (!pl || !clip || inst->playlist_index >= pl->clips.Size) return 0.0f;
+	refresh_playlist_starts(pl);
+	float elapsed = ImMax(clip->delay - inst->delay_left, 0.0f);
+	if (inst->delay_left <= 0.0f)
+		elapsed += (inst->dir_sign > 0) ? inst->time : clip->duration - inst->time;
+	return pl->start[inst->playlist_index] + elapsed;
+}
+
 float iam_instance::time() const {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	return inst ? inst->time : 0.0f;
 }
 
 float iam_instance::duration() const {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (!inst) return 0.0f;
 	iam_clip_data* clip = get_clip_data(inst->clip_id);
 	return clip ? clip->duration : 0.0f;
 }
 
 bool iam_instance::is_playing() const {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	return inst ? inst->playing : false;
 }
 
 bool iam_instance::is_paused() const {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	return inst ? inst->paused : false;
 }
 
+bool iam_instance::is_pending() const {
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	return inst ? inst->pending_load : false;
+}
+
 bool iam_instance::get_float(ImGuiID channel, float* out) const {
 	using namespace iam_clip_detail;
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (!inst || !out) return false;
-
-	// Check if this channel is a relative float track (stored as vec2: percent, px_bias)
 	iam_clip_data* clip = find_clip(inst->clip_id);
-	if (clip) {
-		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
-			iam_track& trk = clip->iam_tracks[t];
-			if (trk.channel == channel && trk.type == iam_chan_float_rel) {
-				// Find the stored percent/px_bias in values_vec2
-				for (int i = 0; i < inst->values_vec2.Size; ++i) {
-					if (inst->values_vec2[i].ch == channel) {
-						float percent = inst->values_vec2[i].v.x;
-						float px_bias = inst->values_vec2[i].v.y;
-						// Resolve anchor
-						ImVec2 anchor = iam_anchor_size(trk.anchor_space);
-						float base = (trk.anchor_axis == 0) ? anchor.x : anchor.y;
-						*out = base * percent + px_bias;
-						return true;
-					}
-				}
-				*out = 0.0f;
-				return false;
-			}
-		}
-	}
-
-	// Normal float channel
-	*out = inst->values_float.GetFloat(channel, 0.0f);
+	int tr = find_bound_track(inst, clip, channel, iam_chan_float);
+	if (tr < 0) { *out = 0.0f; return true; }
+	float v[4], tmp[8];
+	read_track_value(clip->iam_tracks[tr], track_read_values(inst, clip, tr, tmp), v);
+	*out = v[0];
 	return true;
 }
 
 bool iam_instance::get_vec2(ImGuiID channel, ImVec2* out) const {
 	using namespace iam_clip_detail;
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (!inst || !out) return false;
-
-	// Check if this channel is a relative vec2 track (stored as vec4: percent.xy, px_bias.xy)
 	iam_clip_data* clip = find_clip(inst->clip_id);
-	if (clip) {
-		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
-			iam_track& trk = clip->iam_tracks[t];
-			if (trk.channel == channel && trk.type == iam_chan_vec2_rel) {
-				// Find the stored percent/px_bias in values_vec4
-				for (int i = 0; i < inst->values_vec4.Size; ++i) {
-					if (inst->values_vec4[i].ch == channel) {
-						ImVec4& v = inst->values_vec4[i].v;
-						ImVec2 percent(v.x, v.y);
-						ImVec2 px_bias(v.z, v.w);
-						// Resolve anchor
-						ImVec2 anchor = iam_anchor_size(trk.anchor_space);
-						*out = ImVec2(anchor.x * percent.x + px_bias.x, anchor.y * percent.y + px_bias.y);
-						return true;
-					}
-				}
-				*out = ImVec2(0, 0);
-				return false;
-			}
-		}
-	}
-
-	// Normal vec2 channel
-	for (int i = 0; i < inst->values_vec2.Size; ++i) {
-		if (inst->values_vec2[i].ch == channel) {
-			*out = inst->values_vec2[i].v;
-			return true;
-		}
-	}
-	*out = ImVec2(0, 0);
-	return false;
+	int tr = find_bound_track(inst, clip, channel, iam_chan_vec2);
+	if (tr < 0) { *out = ImVec2(0, 0); return false; }
+	float v[4], tmp[8];
+	read_track_value(clip->iam_tracks[tr], track_read_values(inst, clip, tr, tmp), v);
+	*out = ImVec2(v[0], v[1]);
+	return true;
 }
 
 bool iam_instance::get_vec4(ImGuiID channel, ImVec4* out) const {
 	using namespace iam_clip_detail;
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (!inst || !out) return false;
+	iam_clip_data* clip = find_clip(inst->clip_id);
+	int tr = find_bound_track(inst, clip, channel, iam_chan_vec4);
+	if (tr < 0) { *out = ImVec4(0, 0, 0, 0); return false; }
+	float v[4], tmp[8];
+	read_track_value(clip->iam_tracks[tr], track_read_values(inst, clip, tr, tmp), v);
+	*out = ImVec4(v[0], v[1], v[2], v[3]);
+	return true;
+}
 
-	// Check if this channel is a relative vec4 track
+bool iam_instance::get_int(ImGuiID channel, int* out) const {
+	using namespace iam_clip_detail;
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (!inst || !out) return false;
 	iam_clip_data* clip = find_clip(inst->clip_id);
-	if (clip) {
-		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
-			iam_track& trk = clip->iam_tracks[t];
-			if (trk.channel == channel && trk.type == iam_chan_vec4_rel) {
-				// Find the stored percent/px_bias in values_vec4_rel
-				for (int i = 0; i < inst->values_vec4_rel.Size; ++i) {
-					if (inst->values_vec4_rel[i].ch == channel) {
-						ImVec4 percent = inst->values_vec4_rel[i].percent;
-						ImVec4 px_bias = inst->values_vec4_rel[i].px_bias;
-						// Resolve anchor - x,y use anchor dimensions, z,w pass through
-						ImVec2 anchor = iam_anchor_size(trk.anchor_space);
-						*out = ImVec4(
-							anchor.x * percent.x + px_bias.x,
-							anchor.y * percent.y + px_bias.y,
-							percent.z + px_bias.z,  // z,w not anchor-relative
-							percent.w + px_bias.w
-						);
-						return true;
-					}
-				}
-				*out = ImVec4(0, 0, 0, 0);
-				return false;
-			}
-		}
-	}
-
-	// Normal vec4 channel
-	for (int i = 0; i < inst->values_vec4.Size; ++i) {
-		if (inst->values_vec4[i].ch == channel) {
-			*out = inst->values_vec4[i].v;
-			return true;
-		}
-	}
-	*out = ImVec4(0, 0, 0, 0);
-	return false;
-}
-
-bool iam_instance::get_int(ImGuiID channel, int* out) const {
-	iam_instance_data* inst = get_instance_data(m_inst_id);
-	if (!inst || !out) return false;
-	*out = inst->values_int.GetInt(channel, 0);
+	int tr = find_bound_track(inst, clip, channel, iam_chan_int);
+	if (tr < 0) { *out = 0; return true; }
+	float tmp[8];
+	memcpy(out, track_read_values(inst, clip, tr, tmp), sizeof(int));
 	return true;
 }
 
 bool iam_instance::get_color(ImGuiID channel, ImVec4* out, int color_space) const {
 	using namespace iam_clip_detail;
-	iam_instance_data* inst = get_instance_data(m_inst_id);
+	IM_UNUSED(color_space);  // Values are stored in sRGB after blending in the track's color space
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
 	if (!inst || !out) return false;
-
-	// Check if this channel is a relative color track
 	iam_clip_data* clip = find_clip(inst->clip_id);
-	if (clip) {
-		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
-			iam_track& trk = clip->iam_tracks[t];
-			if (trk.channel == channel && trk.type == iam_chan_color_rel) {
-				// Find the stored percent/px_bias in values_color_rel
-				for (int i = 0; i < inst->values_color_rel.Size; ++i) {
-					if (inst->values_color_rel[i].ch == channel) {
-						ImVec4 percent = inst->values_color_rel[i].percent;
-						ImVec4 px_bias = inst->values_color_rel[i].px_bias;
-						// Resolve anchor - apply to all 4 components (RGBA)
-						ImVec2 anchor = iam_anchor_size(trk.anchor_space);
-						// For color, use anchor.x for R,B and anchor.y for G,A (or could be all same)
-						// Most common use: all components scale the same way
-						*out = ImVec4(
-							anchor.x * percent.x + px_bias.x,
-							anchor.y * percent.y + px_bias.y,
-							anchor.x * percent.z + px_bias.z,
-							anchor.y * percent.w + px_bias.w
-						);
-						return true;
-					}
-				}
-				*out = ImVec4(0, 0, 0, 1);
-				return false;
-			}
-		}
-	}
+	int tr = find_bound_track(inst, clip, channel, iam_chan_color);
+	if (tr < 0) { *out = ImVec4(0, 0, 0, 1); return false; }
+	float v[4], tmp[8];
+	read_track_value(clip->iam_tracks[tr], track_read_values(inst, clip, tr, tmp), v);
+	*out = ImVec4(v[0], v[1], v[2], v[3]);
+	return true;
+}
 
-	// Normal color channel
-	for (int i = 0; i < inst->values_color.Size; ++i) {
-		if (inst->values_color[i].ch == channel) {
-			// If requested color space differs from stored, convert
-			if (color_space != inst->values_color[i].color_space) {
-				// Convert from stored sRGB to requested color space and back
-				// Note: values are stored in sRGB after lerp_color
-				*out = inst->values_color[i].v;
-			} else {
-				*out = inst->values_color[i].v;
-			}
-			return true;
+int iam_instance::get_all(void* out_struct, iam_channel_binding const* bindings, int count) const {
+	using namespace iam_clip_detail;
+	iam_instance_data* inst = get_instance_data(m_inst_id, m_handle);
+	if (!inst || !out_struct || !bindings) return 0;
+	iam_clip_data* clip = find_clip(inst->clip_id);
+	if (!clip || inst->values_layout != clip->layout_version) return 0;
+
+	char* base = (char*)out_struct;
+	int written = 0;
+	float tmp[8];
+	for (int i = 0; i < count; ++i) {
+		iam_channel_binding const& b = bindings[i];
+		int kind = track_value_kind(b.type);
+		int idx = clip->channel_index.GetInt(channel_key(b.channel, kind), 0);
+		if (idx == 0) continue;  // Member left untouched
+		iam_track const& trk = clip->iam_tracks[idx - 1];
+		float const* src = track_read_values(inst, clip, idx - 1, tmp);
+		if (kind == iam_chan_int) {
+			memcpy(base + b.offset, src, sizeof(int));
+		} else {
+			float v[4];
+			read_track_value(trk, src, v);
+			int n = (kind == iam_chan_float) ? 1 : (kind == iam_chan_vec2) ? 2 : 4;
+			memcpy(base + b.offset, v, sizeof(float) * n);
 		}
+		written++;
 	}
-	*out = ImVec4(0, 0, 0, 1);
-	return false;
+	return written;
 }
 
 // ----------------------------------------------------
@@ -3148,239 +4616,671 @@ void iam_clip_init(int initial_clip_cap, int initial_inst_cap) {
 
 void iam_clip_shutdown() {
 	using namespace iam_clip_detail;
+	for (int c = 0; c < g_clip_sys.clips.Size; ++c)
+		release_clip_data(&g_clip_sys.clips[c]);
 	g_clip_sys.clips.clear();
 	g_clip_sys.instances.clear();
+
+	// Library: requests still in flight on a worker are left to it (their memory is not reclaimed)
+	iam_clip_library& lib = g_clip_sys.library;
+	for (int e = 0; e < lib.entries.Size; ++e) {
+		iam_clip_stream_request* req = lib.entries[e].request;
+		if (req && req->state.load(std::memory_order_acquire) != 0) free_stream_request(req);
+	}
+	lib.entries.clear();
+	lib.entry_map.Clear();
+	lib.sources.clear();
+	lib.path_pool.clear();
+	lib.resident_bytes = 0;
+	lib.loading = 0;
+	for (int p = 0; p < g_clip_sys.packs.Size; ++p)
+		release_pack_storage(g_clip_sys.packs[p]);
+	g_clip_sys.packs.clear();
+	for (int g = 0; g < g_clip_sys.graphs.Size; ++g)
+		IM_DELETE(g_clip_sys.graphs[g]);
+	g_clip_sys.graphs.clear();
+	g_clip_sys.graph_map.Clear();
+	g_clip_sys.graph_build = nullptr;
+	for (int p = 0; p < g_clip_sys.playlists.Size; ++p)
+		IM_DELETE(g_clip_sys.playlists[p]);
+	g_clip_sys.playlists.clear();
+	g_clip_sys.playlist_map.Clear();
+	for (int m = 0; m < g_clip_sys.machines.Size; ++m)
+		IM_DELETE(g_clip_sys.machines[m]);
+	g_clip_sys.machines.clear();
+	g_clip_sys.machine_map.Clear();
+	g_clip_sys.machine_build = nullptr;
+	for (int p = 0; p < g_clip_sys.players.Size; ++p)
+		IM_DELETE(g_clip_sys.players[p]);
+	g_clip_sys.players.clear();
+	g_clip_sys.player_map.Clear();
+	g_clip_sys.players_dirty.clear();
+	g_clip_sys.players_fading.clear();
+#ifdef IAM_HAS_COROUTINES
+	destroy_tasks();
+#endif
+	iam_clip_set_event_queue(0);
 	g_clip_sys.clip_map.Clear();
 	g_clip_sys.inst_map.Clear();
+	g_clip_sys.eval_cache_index.Clear();
+	g_clip_sys.eval_cache_entries.clear();
+	g_clip_sys.eval_cache_values.clear();
+	g_clip_sys.budget_order.clear();
 	g_clip_sys.initialized = false;
 }
 
-void iam_clip_update(float dt) {
+// Advance one instance by dt and evaluate its tracks. Only the instance itself is written (clips are
+// read-only here), so ranges of instances can be advanced on worker threads. Callbacks, markers and
+// chaining are queued on the instance and fired by dispatch_instance_events.
+static void advance_instance(iam_instance_data* inst, float dt) {
 	using namespace iam_clip_detail;
-	g_clip_sys.frame_counter++;
-
-	// Apply global time scale
-	dt *= iam_detail::g_time_scale;
-
-	// Safety: clamp dt to reasonable range
-	if (dt < 0.0f) dt = 0.0f;
-	if (dt > 1.0f) dt = 1.0f;
+	if (inst->pending_load) return;  // Started by library_poll once the clip is resident
+	iam_clip_data* clip = find_clip(inst->clip_id);
+	if (!inst->playing || inst->paused || !clip) return;
 
-	for (int i = 0; i < g_clip_sys.instances.Size; ++i) {
-		iam_instance_data* inst = &g_clip_sys.instances[i];
-		iam_clip_data* clip = find_clip(inst->clip_id);
-		if (!inst->playing || inst->paused || !clip) continue;
+	// Hidden: advance as usual, but leave track evaluation to reads (a set_cull_rect missed last frame means hidden)
+	inst->culled = inst->hidden || (inst->cull_rect && !(inst->cull_visible && inst->cull_frame + 1 == g_clip_sys.frame_counter));
 
-		// Use local copy of dt for this instance to avoid affecting other instances
-		float inst_dt = dt;
+	// Use local copy of dt for this instance to avoid affecting other instances
+	float inst_dt = dt;
 
-		// Handle delay
+	// Handle delay
+	if (inst->delay_left > 0.0f) {
+		inst->delay_left -= inst_dt;
 		if (inst->delay_left > 0.0f) {
-			inst->delay_left -= inst_dt;
-			if (inst->delay_left > 0.0f) {
-				// Still evaluate tracks at t=0 so values are readable during delay
-				for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
-					eval_iam_track(clip->iam_tracks[tr], 0.0f, inst);
-				}
-				inst->last_seen_frame = g_clip_sys.frame_counter;
-				continue;
-			}
-			inst_dt = -inst->delay_left;
-			inst->delay_left = 0.0f;
-			// Call on_begin when delay expires
-			if (!inst->begin_called && clip->cb_begin) {
-				inst->begin_called = true;
-				clip->cb_begin(inst->inst_id, clip->cb_begin_user);
-			}
+			// Still evaluate tracks at t=0 so values are readable during delay
+			schedule_eval(clip, 0.0f, inst);
+			inst->last_seen_frame = g_clip_sys.frame_counter;
+			return;
 		}
+		inst_dt = -inst->delay_left;
+		inst->delay_left = 0.0f;
+	}
+
+	// on_begin fires on the first advanced frame (once any delay has expired)
+	if (!inst->begin_called && (clip->cb_begin || g_clip_sys.events.data)) {
+		inst->begin_called = true;
+		inst->pending_events |= clip_event_begin;
+	}
 
-		// Call on_begin on first frame if no delay
-		if (!inst->begin_called && clip->cb_begin) {
-			inst->begin_called = true;
-			clip->cb_begin(inst->inst_id, clip->cb_begin_user);
+	// Instanced playback: lanes follow a shared clock with per-lane looping, no markers or timing variation
+	if (inst->lane_count > 0) {
+		inst->lane_clock += inst_dt * (inst->time_scale <= 0.0f ? 1.0f : inst->time_scale);
+		bool done = compute_lane_times(clip, inst);
+		eval_instance_lanes(clip, inst);
+		inst->time = inst->lane_time[0];  // Lane 0 stays readable through get_*
+		inst->last_seen_frame = g_clip_sys.frame_counter;
+		if (done) {
+			inst->playing = false;
+			inst->pending_events |= clip_event_complete;
+		} else if (clip->cb_update) {
+			inst->pending_events |= clip_event_update;
 		}
+		return;
+	}
 
-		float t = inst->time;
-		float dts = inst_dt * (inst->time_scale <= 0.0f ? 1.0f : inst->time_scale);
-		t += dts * (float)inst->dir_sign;
+	float t = inst->time;
+	int pass_dir = inst->dir_sign;
+	if (inst->marker_layout != clip->layout_version) place_marker_cursor(inst, clip, inst->prev_time);  // Clip rebuilt
+	float dts = inst_dt * (inst->time_scale <= 0.0f ? 1.0f : inst->time_scale);
+	t += dts * (float)inst->dir_sign;
 
-		// Apply duration variation if present
-		float dur = clip->duration;
-		if (clip->has_duration_var) {
-			dur = apply_var_float(clip->duration, clip->duration_var, inst->current_loop, &inst->var_rng_state);
-			if (dur < 0.001f) dur = 0.001f;  // Minimum duration
-		}
-		bool done = false;
+	// Apply duration variation if present
+	float dur = clip->duration;
+	if (clip->has_duration_var) {
+		dur = apply_var_float(clip->duration, clip->duration_var, inst->current_loop, &inst->var_rng_state);
+		if (dur < 0.001f) dur = 0.001f;  // Minimum duration
+	}
+	bool done = false;
+	bool playlist = inst->playlist_id != 0;  // Playlist entries play one pass
 
-		if (dur <= 0.0f) { inst->time = 0.0f; continue; }
+	if (dur <= 0.0f) {
+		inst->time = 0.0f;
+		if (playlist && next_playlist_entry(inst)) advance_instance(inst, inst_dt);  // Skip empty entries
+		return;
+	}
 
-		// Handle looping (with safety limit to prevent infinite loops)
-		int const MAX_LOOP_ITERS = 1000;
-		int loop_iters = 0;
-		if (clip->direction == iam_dir_alternate) {
-			while ((t < 0.0f || t > dur) && loop_iters < MAX_LOOP_ITERS) {
-				if (clip->loop_count == 0 && inst->loops_left == 0) { done = true; break; }
-				if (inst->loops_left > 0) inst->loops_left--;
-				inst->dir_sign = -inst->dir_sign;
-				if (t < 0.0f) t = -t;
-				if (t > dur) t = 2*dur - t;
-				loop_iters++;
-			}
-		} else if (clip->direction == iam_dir_reverse) {
-			while (t < 0.0f && loop_iters < MAX_LOOP_ITERS) {
-				if (clip->loop_count == 0 && inst->loops_left == 0) { done = true; break; }
-				if (inst->loops_left > 0) inst->loops_left--;
-				t += dur;
-				loop_iters++;
-			}
-			while (t > dur && loop_iters < MAX_LOOP_ITERS) { t -= dur; loop_iters++; }
-		} else { // normal
-			while (t > dur && loop_iters < MAX_LOOP_ITERS) {
-				if (clip->loop_count == 0 && inst->loops_left == 0) { done = true; break; }
-				if (inst->loops_left > 0) inst->loops_left--;
-				t -= dur;
-				loop_iters++;
+	// Handle looping (with safety limit to prevent infinite loops)
+	int const MAX_LOOP_ITERS = 1000;
+	int loop_iters = 0;
+	if (clip->direction == iam_dir_alternate) {
+		while ((t < 0.0f || t > dur) && loop_iters < MAX_LOOP_ITERS) {
+			if (playlist || (clip->loop_count == 0 && inst->loops_left == 0)) { done = true; break; }
+			if (inst->loops_left > 0) inst->loops_left--;
+			inst->dir_sign = -inst->dir_sign;
+			if (t < 0.0f) t = -t;
+			if (t > dur) t = 2*dur - t;
+			loop_iters++;
+		}
+	} else if (clip->direction == iam_dir_reverse) {
+		while (t < 0.0f && loop_iters < MAX_LOOP_ITERS) {
+			if (playlist || (clip->loop_count == 0 && inst->loops_left == 0)) { done = true; break; }
+			if (inst->loops_left > 0) inst->loops_left--;
+			t += dur;
+			loop_iters++;
+		}
+		while (t > dur && loop_iters < MAX_LOOP_ITERS) { t -= dur; loop_iters++; }
+	} else { // normal
+		while (t > dur && loop_iters < MAX_LOOP_ITERS) {
+			if (playlist || (clip->loop_count == 0 && inst->loops_left == 0)) { done = true; break; }
+			if (inst->loops_left > 0) inst->loops_left--;
+			t -= dur;
+			loop_iters++;
+		}
+		while (t < 0.0f && loop_iters < MAX_LOOP_ITERS) { t += dur; loop_iters++; }
+	}
+	float overshoot = (t > dur) ? t - dur : (t < 0.0f ? -t : 0.0f);  // Past the end of a finished pass
+
+	// Safety clamp
+	if (t < 0.0f) t = 0.0f;
+	if (t > dur) t = dur;
+
+	// The pass that ended this frame crossed every marker left up to its end
+	if ((loop_iters > 0 || done) && clip->markers.Size > 0)
+		queue_crossed_markers(inst, clip, (pass_dir > 0) ? dur : 0.0f, pass_dir);
+
+	// Restart markers on loop and increment loop counter for variation
+	if (loop_iters > 0) {
+		inst->current_loop += loop_iters;
+		if (g_clip_sys.events.data) inst->pending_markers.push_back(-1);  // Loop event, in order with markers
+		// The new pass starts at its beginning; a ping-pong bounce does not re-cross its turning point
+		inst->prev_time = (inst->dir_sign > 0) ? 0.0f : dur;
+		if (clip->direction == iam_dir_alternate)
+			inst->marker_cursor = (inst->dir_sign > 0) ? marker_upper_bound(clip, 0.0f) : marker_lower_bound(clip, dur);
+		else
+			inst->marker_cursor = (inst->dir_sign > 0) ? 0 : clip->markers.Size;
+
+		// Apply timing variations for new loop iteration
+		if (clip->has_timescale_var) {
+			float new_scale = apply_var_float(1.0f, clip->timescale_var, inst->current_loop, &inst->var_rng_state);
+			inst->time_scale = new_scale > 0.0f ? new_scale : 1.0f;
+		}
+		if (clip->has_delay_var) {
+			float loop_delay = apply_var_float(0.0f, clip->delay_var, inst->current_loop, &inst->var_rng_state);
+			if (loop_delay > 0.0f) {
+				inst->delay_left = loop_delay;
 			}
-			while (t < 0.0f && loop_iters < MAX_LOOP_ITERS) { t += dur; loop_iters++; }
 		}
-		// Safety clamp
-		if (t < 0.0f) t = 0.0f;
-		if (t > dur) t = dur;
+	}
 
-		// Reset markers on loop and increment loop counter for variation
-		if (loop_iters > 0) {
-			inst->current_loop += loop_iters;
-			for (int m = 0; m < inst->markers_triggered.Size; m++) {
-				inst->markers_triggered[m] = false;
+	if (done) {
+		// Playlist: continue into the next entry with the time left over past the end of this pass
+		if (playlist) {
+			float scale = inst->time_scale <= 0.0f ? 1.0f : inst->time_scale;
+			if (next_playlist_entry(inst)) {
+				advance_instance(inst, overshoot / scale);
+				return;
 			}
-			// Reset prev_time to avoid triggering all markers at once after loop
-			inst->prev_time = (inst->dir_sign > 0) ? 0.0f : dur;
+		}
+		inst->playing = false;
+		inst->time = (inst->dir_sign > 0) ? dur : 0.0f;
+		// Evaluate final frame (exact, even between ticks)
+		eval_instance_tracks(clip, inst->time, inst);
+		inst->tick_prev_layout = 0;
+		inst->last_seen_frame = g_clip_sys.frame_counter;
+		inst->pending_events |= clip_event_complete;
+		return;
+	}
 
-			// Apply timing variations for new loop iteration
-			if (clip->has_timescale_var) {
-				float new_scale = apply_var_float(1.0f, clip->timescale_var, inst->current_loop, &inst->var_rng_state);
-				inst->time_scale = new_scale > 0.0f ? new_scale : 1.0f;
-			}
-			if (clip->has_delay_var) {
-				float loop_delay = apply_var_float(0.0f, clip->delay_var, inst->current_loop, &inst->var_rng_state);
-				if (loop_delay > 0.0f) {
-					inst->delay_left = loop_delay;
-				}
-			}
+	// Queue markers crossed since prev_time (forward or backward); only markers past the cursor are visited
+	inst->time = t;
+	queue_crossed_markers(inst, clip, t, inst->dir_sign);
+	inst->prev_time = t;
+
+	// Evaluate all iam_tracks
+	schedule_eval(clip, t, inst);
+
+	if (clip->cb_update)
+		inst->pending_events |= clip_event_update;
+
+	inst->last_seen_frame = g_clip_sys.frame_counter;
+}
+
+// Record an event for iam_poll_events (no-op while the queue is disabled). Full queue: the event is dropped.
+// clip_id defaults to the instance's current clip.
+static void push_event(int type, iam_instance_data const* inst, ImGuiID marker_id, ImGuiID chained_id, float time, ImGuiID clip_id = 0) {
+	using namespace iam_clip_detail;
+	iam_event_ring& ring = g_clip_sys.events;
+	if (!ring.data) return;
+	unsigned head = ring.head.load(std::memory_order_relaxed);
+	if (head - ring.tail.load(std::memory_order_acquire) > ring.mask) {
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	iam_event& e = ring.data[head & ring.mask];
+	e.type = type;
+	e.instance_id = inst->inst_id;
+	e.clip_id = clip_id ? clip_id : inst->clip_id;
+	e.marker_id = marker_id;
+	e.chained_id = chained_id;
+	e.time = time;
+	e.loop = inst->current_loop;
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+// Fire what advance_instance queued, in order: begin, markers (and loop wraps), update, complete, chain.
+// Instance slots never move, but callbacks may rebuild clips (reallocating the clip array), so clips are re-fetched after each one.
+static void dispatch_instance_events(iam_instance_data* inst) {
+	using namespace iam_clip_detail;
+	g_clip_sys.stat_tracks_evaluated += inst->frame_tracks_evaluated;
+	g_clip_sys.stat_tracks_deferred += inst->frame_tracks_deferred;
+	g_clip_sys.stat_tracks_lazy += inst->frame_tracks_lazy;
+	inst->frame_tracks_evaluated = 0;
+	inst->frame_tracks_deferred = 0;
+	inst->frame_tracks_lazy = 0;
+	if (inst->culled) {
+		g_clip_sys.stat_instances_culled++;
+		inst->culled = false;
+	}
+
+	int events = inst->pending_events;
+	if (events == 0 && inst->pending_markers.Size == 0) return;
+	inst->pending_events = 0;
+	ImGuiID inst_id = inst->inst_id;
+	ImGuiID clip_id = inst->clip_id;
+
+	// Playlist entries passed this frame: start from the entry the frame began in
+	ImGuiID playlist_id = 0;
+	int entry = -1;
+	if (inst->playlist_id != 0) {
+		int switches = 0;
+		for (int i = 0; i < inst->pending_markers.Size; ++i)
+			if (inst->pending_markers[i] == -2) switches++;
+		iam_playlist_data const* pl = switches > 0 ? find_playlist(inst->playlist_id) : nullptr;
+		entry = inst->playlist_index - switches;
+		if (pl && entry >= 0) {
+			playlist_id = inst->playlist_id;
+			clip_id = pl->clips[entry];
 		}
+	}
 
-		if (done) {
-			inst->playing = false;
-			inst->time = (inst->dir_sign > 0) ? dur : 0.0f;
-			// Evaluate final frame
-			for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
-				eval_iam_track(clip->iam_tracks[tr], inst->time, inst);
-			}
-			inst->last_seen_frame = g_clip_sys.frame_counter;
-			if (clip->cb_complete)
-				clip->cb_complete(inst->inst_id, clip->cb_complete_user);
-
-			// Start chained clip if any
-			if (inst->chain_next_clip_id != 0) {
-				ImGuiID next_clip = inst->chain_next_clip_id;
-				ImGuiID next_inst = inst->chain_next_inst_id;
-				float chain_delay = inst->chain_delay;
-
-				// Clear the chain to prevent re-triggering
-				inst->chain_next_clip_id = 0;
-				inst->chain_next_inst_id = 0;
-				inst->chain_delay = 0;
-
-				// Play the chained clip
-				iam_instance next = iam_play(next_clip, next_inst);
-				if (next.valid() && chain_delay > 0) {
-					// Apply chain delay
-					iam_instance_data* next_data = find_instance(next_inst);
-					if (next_data) {
-						next_data->delay_left += chain_delay;
-					}
-				}
-			}
+	iam_clip_data* clip = find_clip(clip_id);
+	if (events & clip_event_begin) {
+		push_event(iam_event_begin, inst, 0, 0, inst->time, clip_id);
+		if (clip && clip->cb_begin)
+			clip->cb_begin(inst_id, clip->cb_begin_user);
+	}
+
+	for (int i = 0; i < inst->pending_markers.Size; ++i) {
+		int m = inst->pending_markers[i];
+		if (m == -1) { push_event(iam_event_loop, inst, 0, 0, inst->time, clip_id); continue; }
+		if (m == -2) {
+			// Next playlist entry: complete the finished clip, begin the next one
+			clip = find_clip(clip_id);
+			float end_time = (clip && clip->direction != iam_dir_reverse) ? clip->duration : 0.0f;
+			push_event(iam_event_complete, inst, 0, 0, end_time, clip_id);
+			if (clip && clip->cb_complete)
+				clip->cb_complete(inst_id, clip->cb_complete_user);
+			iam_playlist_data const* pl = find_playlist(playlist_id);
+			if (!pl || ++entry >= pl->clips.Size) break;  // Playlist replaced by a callback
+			clip_id = pl->clips[entry];
+			clip = find_clip(clip_id);
+			push_event(iam_event_begin, inst, 0, 0, 0.0f, clip_id);
+			if (clip && clip->cb_begin)
+				clip->cb_begin(inst_id, clip->cb_begin_user);
 			continue;
 		}
+		clip = find_clip(clip_id);
+		if (!clip || m >= clip->markers.Size) break;  // Clip rebuilt by a callback
+		iam_marker marker = clip->markers[m];
+		push_event(iam_event_marker, inst, marker.marker_id, 0, marker.time, clip_id);
+		if (g_clip_sys.task_marker_waits.Size > 0 && marker.marker_id != 0)
+			wake_instance_tasks(g_clip_sys.task_marker_waits, inst_id, marker.marker_id, false);
+		if (marker.callback)
+			marker.callback(inst_id, marker.marker_id, marker.time, marker.user_data);
+	}
+	inst->pending_markers.resize(0);
+	if (playlist_id != 0 && inst->inst_id == inst_id) clip_id = inst->clip_id;
+
+	clip = find_clip(clip_id);
+	if (clip && (events & clip_event_update) && clip->cb_update)
+		clip->cb_update(inst_id, clip->cb_update_user);
+
+	if (!(events & clip_event_complete)) return;
+	if (g_clip_sys.task_inst_waits.Size > 0) wake_instance_tasks(g_clip_sys.task_inst_waits, inst_id, 0, false);
+	if (inst->sm_player_id != 0) g_clip_sys.players_dirty.push_back(inst->sm_player_id);  // iam_sm_complete transitions
+	push_event(iam_event_complete, inst, 0, 0, inst->time);
+	clip = find_clip(clip_id);
+	if (clip && clip->cb_complete)
+		clip->cb_complete(inst_id, clip->cb_complete_user);
+
+	// Start chained clip if any
+	if (inst->inst_id == inst_id && inst->chain_next_clip_id != 0) {
+		ImGuiID next_clip = inst->chain_next_clip_id;
+		ImGuiID next_inst = inst->chain_next_inst_id;
+		float chain_delay = inst->chain_delay;
+		int time_domain = inst->time_domain;
+
+		// Clear the chain to prevent re-triggering
+		inst->chain_next_clip_id = 0;
+		inst->chain_next_inst_id = 0;
+		inst->chain_delay = 0;
+
+		// Play the chained clip
+		iam_instance next = iam_play(next_clip, next_inst);
+		if (next.valid() && inst->inst_id == inst_id)
+			push_event(iam_event_chain, inst, 0, next_inst, inst->time);
+		iam_instance_data* next_data = next.valid() ? find_instance(next_inst) : nullptr;
+		if (next_data) {
+			next_data->time_domain = time_domain;  // Chains stay in the time domain they started in
+			next_data->delay_left += chain_delay;  // Apply chain delay
+		}
+	}
+}
+
+// Advance an instance by dt in its time domain. Instances in a paused domain are skipped: no time, no
+// evaluation, no events.
+static void advance_in_domain(iam_instance_data* inst, float dt) {
+	if (inst->time_domain != 0) {
+		iam_detail::time_domain const& domain = iam_detail::g_domains[inst->time_domain - 1];
+		if (domain.paused) return;
+		dt *= domain.scale;
+	}
+	advance_instance(inst, dt);
+}
+
+struct clip_advance_job {
+	float dt;
+};
 
-		// Check for markers crossed between prev_time and t
-		float prev_t = inst->prev_time;
-		inst->time = t;
+static void advance_instance_range(int begin, int end, void* job_user) {
+	using namespace iam_clip_detail;
+	clip_advance_job const* job = (clip_advance_job const*)job_user;
+	for (int i = begin; i < end; ++i)
+		advance_in_domain(g_clip_sys.instances.at(i), job->dt);
+}
 
-		// Initialize markers_triggered if needed
-		if (inst->markers_triggered.Size != clip->markers.Size) {
-			inst->markers_triggered.resize(clip->markers.Size);
-			for (int m = 0; m < inst->markers_triggered.Size; m++) {
-				inst->markers_triggered[m] = false;
-			}
-		}
+static int cmp_budget_entry(void const* a, void const* b) {
+	using namespace iam_clip_detail;
+	iam_budget_entry const* ea = (iam_budget_entry const*)a;
+	iam_budget_entry const* eb = (iam_budget_entry const*)b;
+	if (ea->key != eb->key) return ea->key > eb->key ? -1 : 1;
+	return ea->slot - eb->slot;
+}
 
-		// Fire markers that were crossed
-		// Handle both forward and backward playback
-		float t_min = (prev_t < t) ? prev_t : t;
-		float t_max = (prev_t < t) ? t : prev_t;
-		for (int m = 0; m < clip->markers.Size; m++) {
-			iam_marker const& marker = clip->markers[m];
-			if (!inst->markers_triggered[m] && marker.time >= t_min && marker.time <= t_max) {
-				inst->markers_triggered[m] = true;
-				if (marker.callback) {
-					marker.callback(inst->inst_id, marker.marker_id, marker.time, marker.user_data);
-				}
-			}
+// Evaluate the instances advance_instance queued, highest priority first, until the budget is spent.
+// The rest keep their previous values and move up one step per update they wait, so low priorities still
+// get a turn; when they do, they evaluate at their latest time. At least one instance is evaluated per update.
+static void run_budget_scheduler() {
+	using namespace iam_clip_detail;
+	iam_clip_budget_stats& stats = g_clip_sys.budget_stats;
+	ImVector<iam_budget_entry>& order = g_clip_sys.budget_order;
+	order.resize(0);
+	for (int i = 0; i < g_clip_sys.instances.slot_count; ++i) {
+		iam_instance_data const* inst = g_clip_sys.instances.at(i);
+		if (!inst->budget_due) continue;
+		iam_budget_entry e = { inst->priority + inst->budget_wait, i };
+		order.push_back(e);
+	}
+	stats.evaluated = 0;
+	stats.deferred = 0;
+	stats.max_wait = 0;
+	stats.used_us = 0.0f;
+	stats.overrun_us = 0.0f;
+	if (order.Size == 0) return;
+	qsort(order.Data, (size_t)order.Size, sizeof(iam_budget_entry), cmp_budget_entry);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	float used = 0.0f;
+	for (int n = 0; n < order.Size; ++n) {
+		iam_instance_data* inst = g_clip_sys.instances.at(order[n].slot);
+		if (n > 0 && used >= g_clip_sys.budget_us) {
+			inst->budget_wait++;
+			stats.deferred++;
+			if (inst->budget_wait > stats.max_wait) stats.max_wait = inst->budget_wait;
+			continue;
 		}
+		iam_clip_data const* clip = find_clip(inst->clip_id);
+		if (clip) eval_instance_tick(clip, inst->budget_time, inst);
+		inst->budget_due = false;
+		inst->budget_wait = 0;
+		stats.evaluated++;
+		used = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+	}
+	stats.used_us = used;
+	if (used > g_clip_sys.budget_us) {
+		stats.overrun_us = used - g_clip_sys.budget_us;
+		stats.overrun_updates++;
+	}
+	if (stats.deferred > 0) stats.deferred_updates++;
+}
+
+void iam_clip_set_event_queue(int capacity) {
+	using namespace iam_clip_detail;
+	iam_event_ring& ring = g_clip_sys.events;
+	if (ring.data) IM_FREE(ring.data);
+	ring.data = nullptr;
+	ring.mask = 0;
+	ring.head.store(0, std::memory_order_relaxed);
+	ring.tail.store(0, std::memory_order_relaxed);
+	ring.dropped.store(0, std::memory_order_relaxed);
+	if (capacity <= 0) return;
+	unsigned cap = 1;
+	while (cap < (unsigned)capacity) cap <<= 1;
+	ring.data = (iam_event*)IM_ALLOC(sizeof(iam_event) * cap);
+	ring.mask = cap - 1;
+}
+
+int iam_poll_events(iam_event* out, int max_events) {
+	using namespace iam_clip_detail;
+	iam_event_ring& ring = g_clip_sys.events;
+	if (!ring.data || !out || max_events <= 0) return 0;
+	unsigned tail = ring.tail.load(std::memory_order_relaxed);
+	unsigned count = ring.head.load(std::memory_order_acquire) - tail;
+	if (count > (unsigned)max_events) count = (unsigned)max_events;
+	for (unsigned i = 0; i < count; ++i)
+		out[i] = ring.data[(tail + i) & ring.mask];
+	ring.tail.store(tail + count, std::memory_order_release);
+	return (int)count;
+}
 
-		inst->prev_time = t;
+unsigned iam_clip_events_dropped() {
+	return iam_clip_detail::g_clip_sys.events.dropped.load(std::memory_order_relaxed);
+}
 
-		// Evaluate all iam_tracks
-		for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
-			eval_iam_track(clip->iam_tracks[tr], t, inst);
-		}
+void iam_clip_update(float dt) {
+	using namespace iam_clip_detail;
+	g_clip_sys.frame_counter++;
+	if (g_clip_sys.library.entries.Size > 0) library_poll();
+	g_clip_sys.stat_tracks_evaluated = 0;
+	g_clip_sys.stat_tracks_deferred = 0;
+	g_clip_sys.stat_tracks_lazy = 0;
+	g_clip_sys.stat_instances_culled = 0;
+	g_clip_sys.stat_cache_hits = 0;
+	g_clip_sys.stat_cache_misses = 0;
+	g_clip_sys.eval_cache_index.Clear();
+	g_clip_sys.eval_cache_entries.resize(0);
+	g_clip_sys.eval_cache_values.resize(0);
+
+	// Apply global time scale
+	dt *= iam_detail::g_time_scale;
 
-		if (clip->cb_update)
-			clip->cb_update(inst->inst_id, clip->cb_update_user);
+	// Safety: clamp dt to reasonable range
+	if (dt < 0.0f) dt = 0.0f;
+	if (dt > 1.0f) dt = 1.0f;
 
-		inst->last_seen_frame = g_clip_sys.frame_counter;
+	// Fixed tick rate: a tick is due once tick_interval has elapsed. Reads then trail the newest tick by the
+	// time left over, unless updates are at least a tick long (then they read the newest tick as is).
+	if (g_clip_sys.tick_interval > 0.0f) {
+		float interval = g_clip_sys.tick_interval;
+		g_clip_sys.tick_accum += dt;
+		g_clip_sys.tick_due = g_clip_sys.tick_accum >= interval;
+		if (dt >= interval) {
+			g_clip_sys.tick_accum = 0.0f;
+			g_clip_sys.tick_alpha = 1.0f;
+		} else {
+			if (g_clip_sys.tick_due) g_clip_sys.tick_accum = ImFmod(g_clip_sys.tick_accum, interval);
+			g_clip_sys.tick_alpha = g_clip_sys.tick_accum / interval;
+		}
+		if (g_clip_sys.tick_due) g_clip_sys.tick_serial++;
+	}
+
+	// Free slots are skipped cheaply: a recycled slot is never playing and has nothing queued
+	int count = g_clip_sys.instances.slot_count;
+	if (g_clip_sys.budget_us > 0.0f) {
+		// Budgeted: advance everything, evaluate what the budget allows, then fire events so callbacks
+		// see this update's values. Instances started by callbacks or chaining begin advancing next frame.
+		if (g_clip_sys.parallel_for && count >= g_clip_sys.parallel_grain * 2) {
+			clip_advance_job job = { dt };
+			activate_playlist_clips();
+			g_clip_sys.in_parallel = true;
+			g_clip_sys.parallel_for(count, g_clip_sys.parallel_grain, advance_instance_range, &job, g_clip_sys.parallel_for_user);
+			g_clip_sys.in_parallel = false;
+		} else {
+			for (int i = 0; i < count; ++i)
+				advance_in_domain(g_clip_sys.instances.at(i), dt);
+		}
+		run_budget_scheduler();
+		for (int i = 0; i < count; ++i)
+			dispatch_instance_events(g_clip_sys.instances.at(i));
+	} else if (g_clip_sys.parallel_for && count >= g_clip_sys.parallel_grain * 2) {
+		// Evaluate phase on worker threads, then fire queued events in slot order.
+		// Instances started by callbacks or chaining begin advancing next frame.
+		clip_advance_job job = { dt };
+		activate_playlist_clips();
+		g_clip_sys.in_parallel = true;
+		g_clip_sys.parallel_for(count, g_clip_sys.parallel_grain, advance_instance_range, &job, g_clip_sys.parallel_for_user);
+		g_clip_sys.in_parallel = false;
+		for (int i = 0; i < count; ++i)
+			dispatch_instance_events(g_clip_sys.instances.at(i));
+	} else {
+		// Single-threaded: instances added by chaining in a new slot are advanced in the same frame
+		for (int i = 0; i < g_clip_sys.instances.slot_count; ++i) {
+			iam_instance_data* inst = g_clip_sys.instances.at(i);
+			advance_in_domain(inst, dt);
+			dispatch_instance_events(inst);
+		}
 	}
+
+	if (g_clip_sys.players_dirty.Size > 0 || g_clip_sys.players_fading.Size > 0) update_state_machines(dt);
+#ifdef IAM_HAS_COROUTINES
+	resume_tasks(dt);
+#endif
+
+	for (int g = 0; g < g_clip_sys.graphs.Size; ++g)
+		if (g_clip_sys.graphs[g] != g_clip_sys.graph_build) eval_blend_graph(g_clip_sys.graphs[g]);
+}
+
+void iam_clip_set_parallel_for(iam_parallel_for_fn fn, void* user, int grain) {
+	using namespace iam_clip_detail;
+	g_clip_sys.parallel_for = fn;
+	g_clip_sys.parallel_for_user = user;
+	g_clip_sys.parallel_grain = grain > 0 ? grain : 1;
 }
 
 void iam_clip_gc(unsigned int max_age_frames) {
 	using namespace iam_clip_detail;
-	for (int i = 0; i < g_clip_sys.instances.Size; ++i) {
-		iam_instance_data* inst = &g_clip_sys.instances[i];
+	for (int i = 0; i < g_clip_sys.instances.slot_count; ++i) {
+		iam_instance_data* inst = g_clip_sys.instances.at(i);
+		if (inst->inst_id == 0) continue;  // Free slot
 		if (g_clip_sys.frame_counter - inst->last_seen_frame > max_age_frames) {
-			g_clip_sys.inst_map.SetInt(inst->inst_id, 0);
-			// Swap with last and remove
-			g_clip_sys.instances[i] = g_clip_sys.instances[g_clip_sys.instances.Size - 1];
-			g_clip_sys.instances.pop_back();
-			// Update swapped instance's map entry
-			if (i < g_clip_sys.instances.Size) {
-				g_clip_sys.inst_map.SetInt(g_clip_sys.instances[i].inst_id, i + 1);
-			}
-			i--;
+			free_instance(inst);
 		}
 	}
+	// State machine players the widget stopped touching (play/set_param/get_*)
+	for (int p = g_clip_sys.players.Size - 1; p >= 0; --p)
+		if (g_clip_sys.frame_counter - g_clip_sys.players[p]->last_seen_frame > max_age_frames) free_sm_player(p);
 }
 
-iam_instance iam_play(ImGuiID clip_id, ImGuiID instance_id) {
-	using namespace iam_clip_detail;
-	if (!g_clip_sys.initialized) iam_clip_init();
+// ----------------------------------------------------
+// Time domains
+// ----------------------------------------------------
 
-	iam_clip_data* clip = find_clip(clip_id);
-	if (!clip) return iam_instance(0);
+namespace iam_detail {
 
-	int idx = g_clip_sys.inst_map.GetInt(instance_id, 0);
-	iam_instance_data* inst;
-	if (idx == 0) {
-		g_clip_sys.instances.push_back(iam_instance_data());
-		inst = &g_clip_sys.instances.back();
-		inst->inst_id = instance_id;
-		g_clip_sys.inst_map.SetInt(instance_id, g_clip_sys.instances.Size);
-	} else {
-		inst = &g_clip_sys.instances[idx - 1];
-	}
+static time_domain* find_domain(ImGuiID domain_id) {
+	int slot = domain_id != 0 ? g_domain_map.GetInt(domain_id, 0) : 0;
+	return slot > 0 ? &g_domains[slot - 1] : nullptr;
+}
 
-	inst->clip_id = clip_id;  // Store ID instead of pointer
+} // namespace iam_detail
+
+bool iam_time_domain_create(ImGuiID domain_id, float scale) {
+	using namespace iam_detail;
+	if (domain_id == 0) return false;  // Reserved for the default domain
+	time_domain* d = find_domain(domain_id);
+	if (!d) {
+		int slot = 0;
+		for (int i = 0; i < g_domains.Size && slot == 0; ++i)
+			if (g_domains[i].id == 0) slot = i + 1;
+		if (slot == 0) {
+			time_domain fresh = { 0, 0.0, 0.0, 1.0f, false };
+			g_domains.push_back(fresh);
+			slot = g_domains.Size;
+		}
+		d = &g_domains[slot - 1];
+		d->id = domain_id;
+		d->origin = d->time;
+		d->paused = false;
+		g_domain_map.SetInt(domain_id, slot);
+	}
+	d->scale = scale > 0.0f ? scale : 0.0f;
+	return true;
+}
+
+void iam_time_domain_destroy(ImGuiID domain_id) {
+	using namespace iam_detail;
+	time_domain* d = find_domain(domain_id);
+	if (!d) return;
+	int slot = g_domain_map.GetInt(domain_id, 0);
+	// Instances return to the default domain; channels move on their next tween call
+	iam_clip_detail::iam_instance_slab& instances = iam_clip_detail::g_clip_sys.instances;
+	for (int i = 0; i < instances.slot_count; ++i)
+		if (instances.at(i)->time_domain == slot) instances.at(i)->time_domain = 0;
+	// A pushed domain falls back to the default too, so a recycled slot never captures later calls
+	if (g_domain == slot) g_domain = 0;
+	for (int i = 0; i < g_domain_stack.Size; ++i)
+		if (g_domain_stack[i] == slot) g_domain_stack[i] = 0;
+	d->id = 0;
+	d->scale = 1.0f;
+	d->paused = false;
+	g_domain_map.SetInt(domain_id, 0);
+}
+
+void iam_time_domain_set_scale(ImGuiID domain_id, float scale) {
+	iam_detail::time_domain* d = iam_detail::find_domain(domain_id);
+	if (d) d->scale = scale > 0.0f ? scale : 0.0f;
+}
+
+float iam_time_domain_get_scale(ImGuiID domain_id) {
+	iam_detail::time_domain const* d = iam_detail::find_domain(domain_id);
+	return d ? d->scale : 1.0f;
+}
+
+void iam_time_domain_set_paused(ImGuiID domain_id, bool paused) {
+	iam_detail::time_domain* d = iam_detail::find_domain(domain_id);
+	if (d) d->paused = paused;
+}
+
+bool iam_time_domain_is_paused(ImGuiID domain_id) {
+	iam_detail::time_domain const* d = iam_detail::find_domain(domain_id);
+	return d && d->paused;
+}
+
+double iam_time_domain_time(ImGuiID domain_id) {
+	if (domain_id == 0) return iam_detail::g_global_time;
+	iam_detail::time_domain const* d = iam_detail::find_domain(domain_id);
+	return d ? d->time - d->origin : 0.0;
+}
+
+void iam_push_time_domain(ImGuiID domain_id) {
+	using namespace iam_detail;
+	g_domain_stack.push_back(g_domain);
+	g_domain = domain_id != 0 ? g_domain_map.GetInt(domain_id, 0) : 0;
+}
+
+void iam_pop_time_domain() {
+	using namespace iam_detail;
+	if (g_domain_stack.Size == 0) return;
+	g_domain = g_domain_stack.back();
+	g_domain_stack.pop_back();
+}
+
+namespace iam_clip_detail {
+
+// (Re)start an instance on a resident clip
+static void start_instance(iam_instance_data* inst, iam_clip_data const* clip) {
+	inst->pending_load = false;
 	inst->time = 0.0f;
 	inst->time_scale = 1.0f;
 	inst->weight = 1.0f;
@@ -3394,82 +5294,589 @@ iam_instance iam_play(ImGuiID clip_id, ImGuiID instance_id) {
 
 	// Initialize marker tracking
 	inst->prev_time = (inst->dir_sign > 0) ? 0.0f : clip->duration;
-	inst->markers_triggered.resize(clip->markers.Size);
-	for (int m = 0; m < inst->markers_triggered.Size; m++) {
-		inst->markers_triggered[m] = false;
-	}
-
-	// Reset chaining (can be set after iam_play using .then())
-	inst->chain_next_clip_id = 0;
-	inst->chain_next_inst_id = 0;
-	inst->chain_delay = 0;
+	place_marker_cursor(inst, clip, inst->prev_time);
 
 	// Reset variation state
 	inst->current_loop = 0;
-	inst->var_rng_state = 12345 + instance_id;  // Deterministic but unique per instance
+	inst->var_rng_state = 12345 + inst->inst_id;  // Deterministic but unique per instance
+	inst->var_loop = -1;                          // Re-resolve variations from the fresh seed
 
 	// Evaluate initial frame immediately so values are available right away
 	float initial_time = (inst->dir_sign > 0) ? 0.0f : clip->duration;
-	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
-		eval_iam_track(clip->iam_tracks[tr], initial_time, inst);
-	}
+	eval_instance_tracks(clip, initial_time, inst);
+	inst->tick_prev_layout = 0;
+}
 
-	return iam_instance(instance_id);  // Return iam_instance with ID
+// Start the lanes requested by iam_play_instanced (lane_count and lane_stagger already set)
+static void start_lanes(iam_instance_data* inst, iam_clip_data* clip) {
+	materialize_packed_clip(clip);  // Lane evaluation walks keyframes
+	inst->lane_clock = 0.0f;
+	inst->lane_time.resize(inst->lane_count);
+	compute_lane_times(clip, inst);
+	eval_instance_lanes(clip, inst);
 }
 
-iam_instance iam_get_instance(ImGuiID instance_id) {
+} // namespace iam_clip_detail
+
+iam_instance iam_play(ImGuiID clip_id, ImGuiID instance_id) {
 	using namespace iam_clip_detail;
+	if (!g_clip_sys.initialized) iam_clip_init();
+
+	iam_clip_data* clip = find_clip(clip_id);
+	bool pending = false;
+	if (g_clip_sys.library.entries.Size > 0) clip = library_acquire(clip_id, clip, &pending);
+	if (!clip && !pending) return iam_instance(0);
+
 	iam_instance_data* inst = find_instance(instance_id);
-	return inst ? iam_instance(instance_id) : iam_instance(0);
+	if (!inst) {
+		int slot = g_clip_sys.instances.alloc();
+		inst = g_clip_sys.instances.at(slot);
+		inst->inst_id = instance_id;
+		g_clip_sys.inst_map.SetInt(instance_id, slot + 1);
+	}
+
+	inst->clip_id = clip_id;  // Store ID instead of pointer
+	inst->lane_count = 0;     // Regular playback (see iam_play_instanced)
+	inst->playlist_id = 0;    // Single clip (see iam_play_playlist)
+	inst->playlist_index = 0;
+	inst->sm_player_id = 0;   // Set by state machines after playing
+	inst->time_domain = iam_detail::g_domain;  // iam_push_time_domain
+
+	// Reset chaining (can be set after iam_play using .then())
+	inst->chain_next_clip_id = 0;
+	inst->chain_next_inst_id = 0;
+	inst->chain_delay = 0;
+
+	if (clip) {
+		start_instance(inst, clip);
+	} else {
+		// Streaming: playing but idle until the clip arrives
+		inst->pending_load = true;
+		inst->playing = true;
+		inst->paused = false;
+		inst->last_seen_frame = g_clip_sys.frame_counter;
+	}
+	if (g_clip_sys.library.budget > 0) library_enforce_budget();
+
+	return iam_instance(instance_id, make_instance_handle(inst));  // Return iam_instance with ID + slot handle
 }
 
-float iam_clip_duration(ImGuiID clip_id) {
+iam_instance iam_play_instanced(ImGuiID clip_id, ImGuiID instance_id, int lane_count, float stagger) {
 	using namespace iam_clip_detail;
+	iam_instance result = iam_play(clip_id, instance_id);
+	iam_instance_data* inst = find_instance(instance_id);
 	iam_clip_data* clip = find_clip(clip_id);
-	return clip ? clip->duration : 0.0f;
+	if (!inst || inst->clip_id != clip_id || (!clip && !inst->pending_load)) return result;
+
+	inst->lane_count = lane_count > 0 ? lane_count : 1;
+	inst->lane_stagger = stagger > 0.0f ? stagger : 0.0f;
+	if (clip) start_lanes(inst, clip);  // Otherwise the lanes start with the clip (library_poll)
+	return result;
 }
 
-bool iam_clip_exists(ImGuiID clip_id) {
+iam_result iam_playlist_create(ImGuiID playlist_id, ImGuiID const* clip_ids, int count) {
 	using namespace iam_clip_detail;
-	return find_clip(clip_id) != nullptr;
+	if (!clip_ids || count <= 0) return iam_err_bad_arg;
+	if (!g_clip_sys.initialized) iam_clip_init();
+	iam_playlist_data* pl = find_playlist(playlist_id);
+	if (!pl) {
+		pl = IM_NEW(iam_playlist_data)();
+		pl->id = playlist_id;
+		g_clip_sys.playlists.push_back(pl);
+		g_clip_sys.playlist_map.SetInt(playlist_id, g_clip_sys.playlists.Size);
+	}
+	pl->clips.resize(count);
+	memcpy(pl->clips.Data, clip_ids, sizeof(ImGuiID) * count);
+	pl->start.resize(0);  // Recomputed on first use
+	return iam_ok;
 }
 
-// Stagger helpers
-float iam_stagger_delay(ImGuiID clip_id, int index) {
+void iam_playlist_destroy(ImGuiID playlist_id) {
 	using namespace iam_clip_detail;
-	iam_clip_data* clip = find_clip(clip_id);
-	if (!clip || clip->stagger_count <= 1) return 0.0f;
+	int idx = g_clip_sys.playlist_map.GetInt(playlist_id, 0) - 1;
+	if (idx < 0) return;
+	IM_DELETE(g_clip_sys.playlists[idx]);
+	int last = g_clip_sys.playlists.Size - 1;
+	if (idx != last) {
+		g_clip_sys.playlists[idx] = g_clip_sys.playlists[last];
+		g_clip_sys.playlist_map.SetInt(g_clip_sys.playlists[idx]->id, idx + 1);
+	}
+	g_clip_sys.playlists.pop_back();
+	g_clip_sys.playlist_map.SetInt(playlist_id, 0);
+}
 
-	int count = clip->stagger_count;
-	float delay = clip->stagger_delay;
-	float bias = clip->stagger_center_bias;
+float iam_playlist_duration(ImGuiID playlist_id) {
+	using namespace iam_clip_detail;
+	iam_playlist_data* pl = find_playlist(playlist_id);
+	if (!pl) return 0.0f;
+	refresh_playlist_starts(pl);
+	return pl->start[pl->clips.Size];
+}
 
-	// Calculate delay based on index and center bias
-	// bias = 0: start from beginning (index 0 has 0 delay)
-	// bias = 1: start from center (center indices have 0 delay, edges have max delay)
-	// bias = 0.5: mixed
-	if (bias <= 0.0f) {
-		// Simple linear stagger from start
-		return (float)index * delay;
-	} else {
-		// Stagger from center
-		float center = (float)(count - 1) * 0.5f;
-		float dist_from_center = fabsf((float)index - center);
-		float max_dist = center;
-		if (max_dist > 0.0f) {
-			float linear_delay = (float)index * delay;
-			float center_delay = dist_from_center * delay * 2.0f / (float)count * (float)(count - 1);
-			return linear_delay * (1.0f - bias) + center_delay * bias;
-		}
+iam_instance iam_play_playlist(ImGuiID playlist_id, ImGuiID instance_id) {
+	using namespace iam_clip_detail;
+	iam_playlist_data* pl = find_playlist(playlist_id);
+	if (!pl) return iam_instance(0);
+	iam_instance result = iam_play(pl->clips[0], instance_id);
+	iam_instance_data* inst = find_instance(instance_id);
+	if (!inst) return result;
+	inst->playlist_id = playlist_id;
+	inst->playlist_index = 0;
+	iam_clip_data* clip = find_clip(pl->clips[0]);
+	if (clip && !inst->pending_load) {
+		enter_playlist_entry(inst, clip);
 	}
-	return 0.0f;
+	return result;
 }
 
-iam_instance iam_play_stagger(ImGuiID clip_id, ImGuiID instance_id, int index) {
+void iam_clip_set_lazy_eval(bool enable) {
 	using namespace iam_clip_detail;
-	if (!g_clip_sys.initialized) iam_clip_init();
+	g_clip_sys.lazy_eval = enable;
+}
 
-	iam_clip_data* clip = find_clip(clip_id);
+bool iam_clip_get_lazy_eval() {
+	using namespace iam_clip_detail;
+	return g_clip_sys.lazy_eval;
+}
+
+void iam_clip_get_eval_stats(int* out_evaluated, int* out_skipped) {
+	using namespace iam_clip_detail;
+	int skipped = g_clip_sys.stat_tracks_deferred - g_clip_sys.stat_tracks_lazy;
+	if (out_evaluated) *out_evaluated = g_clip_sys.stat_tracks_evaluated;
+	if (out_skipped) *out_skipped = skipped > 0 ? skipped : 0;
+}
+
+void iam_clip_set_tick_rate(float hz) {
+	using namespace iam_clip_detail;
+	g_clip_sys.tick_interval = hz > 0.0f ? 1.0f / hz : 0.0f;
+	g_clip_sys.tick_accum = 0.0f;
+	g_clip_sys.tick_alpha = 1.0f;
+	g_clip_sys.tick_due = true;
+}
+
+float iam_clip_get_tick_rate() {
+	using namespace iam_clip_detail;
+	return g_clip_sys.tick_interval > 0.0f ? 1.0f / g_clip_sys.tick_interval : 0.0f;
+}
+
+void iam_clip_set_update_budget(float microseconds) {
+	using namespace iam_clip_detail;
+	float budget = microseconds > 0.0f ? microseconds : 0.0f;
+	if (budget > 0.0f && g_clip_sys.budget_us <= 0.0f)
+		memset(&g_clip_sys.budget_stats, 0, sizeof(g_clip_sys.budget_stats));
+	g_clip_sys.budget_us = budget;
+	if (budget > 0.0f) return;
+	// Turned off: bring deferred instances up to date now rather than on their next advance
+	for (int i = 0; i < g_clip_sys.instances.slot_count; ++i) {
+		iam_instance_data* inst = g_clip_sys.instances.at(i);
+		if (!inst->budget_due) continue;
+		inst->budget_wait = 0;
+		iam_clip_data const* clip = find_clip(inst->clip_id);
+		if (clip) eval_instance_tracks(clip, inst->budget_time, inst);
+		inst->budget_due = false;
+	}
+}
+
+float iam_clip_get_update_budget() {
+	using namespace iam_clip_detail;
+	return g_clip_sys.budget_us;
+}
+
+void iam_clip_get_budget_stats(iam_clip_budget_stats* out_stats) {
+	using namespace iam_clip_detail;
+	if (out_stats) *out_stats = g_clip_sys.budget_stats;
+}
+
+int iam_clip_get_culled_count() {
+	using namespace iam_clip_detail;
+	return g_clip_sys.stat_instances_culled;
+}
+
+void iam_clip_set_eval_cache(bool enable, float time_quantum) {
+	using namespace iam_clip_detail;
+	g_clip_sys.eval_cache = enable;
+	g_clip_sys.eval_cache_quantum = time_quantum > 0.0f ? time_quantum : 0.0f;
+	g_clip_sys.eval_cache_index.Clear();
+	g_clip_sys.eval_cache_entries.clear();
+	g_clip_sys.eval_cache_values.clear();
+}
+
+void iam_clip_get_eval_cache_stats(int* out_hits, int* out_misses) {
+	using namespace iam_clip_detail;
+	if (out_hits) *out_hits = g_clip_sys.stat_cache_hits;
+	if (out_misses) *out_misses = g_clip_sys.stat_cache_misses;
+}
+
+iam_instance iam_get_instance(ImGuiID instance_id) {
+	using namespace iam_clip_detail;
+	iam_instance_data* inst = find_instance(instance_id);
+	return inst ? iam_instance(instance_id, make_instance_handle(inst)) : iam_instance(0);
+}
+
+float iam_clip_duration(ImGuiID clip_id) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip = find_clip(clip_id);
+	return clip ? clip->duration : 0.0f;
+}
+
+bool iam_clip_exists(ImGuiID clip_id) {
+	using namespace iam_clip_detail;
+	return find_clip(clip_id) != nullptr;
+}
+
+iam_result iam_clip_bake(ImGuiID clip_id, float sample_rate) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip = find_clip(clip_id);
+	if (!clip) return iam_err_not_found;
+	materialize_packed_clip(clip);
+	if (sample_rate <= 0.0f) {
+		unbake_clip(clip);
+		return iam_ok;
+	}
+	bake_clip(clip, sample_rate);
+	return iam_ok;
+}
+
+iam_result iam_clip_optimize(ImGuiID clip_id, float tolerance, int* out_keys_before, int* out_keys_after) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip = find_clip(clip_id);
+	if (!clip) return iam_err_not_found;
+	if (tolerance < 0.0f) return iam_err_bad_arg;
+	materialize_packed_clip(clip);
+
+	float bake_rate = clip->bake_rate;
+	unbake_clip(clip);  // Reference samples come from live keys
+
+	int before = 0, after = 0;
+	iam_instance_data scratch;
+	scratch.values.resize(16);
+	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
+		iam_track& trk = clip->iam_tracks[tr];
+		before += trk.keys.Size;
+		if (track_is_optimizable(trk))
+			optimize_track(trk, tolerance, &scratch);
+		after += trk.keys.Size;
+	}
+	clip->key_version = ++g_clip_sys.layout_serial;  // Keys only: value slots are unchanged, so playing instances stay bound
+	if (bake_rate > 0.0f) bake_clip(clip, bake_rate);
+
+	if (out_keys_before) *out_keys_before = before;
+	if (out_keys_after) *out_keys_after = after;
+	return iam_ok;
+}
+
+// ----------------------------------------------------
+// In-place key editing - tracks stay sorted and keep their value slots, so playing instances stay bound
+// ----------------------------------------------------
+
+namespace iam_clip_detail {
+
+static iam_track* find_edit_track(iam_clip_data* clip, ImGuiID channel, int type) {
+	int t = clip->channel_index.GetInt(channel_key(channel, track_value_kind(type)), 0) - 1;
+	if (t >= 0 && clip->iam_tracks[t].channel == channel && clip->iam_tracks[t].type == type) return &clip->iam_tracks[t];
+	for (t = 0; t < clip->iam_tracks.Size; ++t)
+		if (clip->iam_tracks[t].channel == channel && clip->iam_tracks[t].type == type) return &clip->iam_tracks[t];
+	return nullptr;
+}
+
+// value holds track_value_size(type) floats; int tracks take the rounded first float
+static void set_key_value(keyframe& k, int type, float const* value) {
+	if (type == iam_chan_int) {
+		k.set_int((int)(value[0] + (value[0] < 0.0f ? -0.5f : 0.5f)));
+		return;
+	}
+	int n = track_value_size(type);
+	memcpy(k.value, value, sizeof(float) * (n > 4 ? 4 : n));
+	if (n > 4) memcpy(k.value_ext, value + 4, sizeof(float) * (n - 4));
+}
+
+// Move keys[index] to its sorted position after a time change; returns the new index
+static int resort_key(ImVector<keyframe>& keys, int index) {
+	keyframe moved;
+	memcpy((void*)&moved, (void const*)&keys[index], sizeof(keyframe));
+	int dst = index;
+	while (dst > 0 && keys[dst - 1].time > moved.time) dst--;
+	while (dst + 1 < keys.Size && keys[dst + 1].time < moved.time) dst++;
+	if (dst < index) memmove((void*)(keys.Data + dst + 1), (void const*)(keys.Data + dst), sizeof(keyframe) * (size_t)(index - dst));
+	else if (dst > index) memmove((void*)(keys.Data + index), (void const*)(keys.Data + index + 1), sizeof(keyframe) * (size_t)(dst - index));
+	memcpy((void*)&keys[dst], (void const*)&moved, sizeof(keyframe));
+	return dst;
+}
+
+// Bookkeeping after one track's keys changed. Duration grows directly; track ends are only rescanned
+// when the key that defined it moved earlier or was removed. A baked clip re-bakes just this track.
+static void commit_key_edit(iam_clip_data* clip, iam_track& trk, float removed_time, float added_time) {
+	if (added_time > clip->duration) {
+		clip->duration = added_time;
+	} else if (removed_time >= clip->duration) {
+		float duration = 0.0f;
+		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+			iam_track const& other = clip->iam_tracks[t];
+			if (other.keys.Size > 0 && other.keys.back().time > duration) duration = other.keys.back().time;
+		}
+		if (clip->markers.Size > 0 && clip->markers.back().time > duration) duration = clip->markers.back().time;  // Markers are sorted
+		clip->duration = duration;
+	}
+	if (trk.var_offset >= 0) assign_var_offsets(clip);  // Slot count follows the key count
+	if (clip->bake_rate > 0.0f) {
+		iam_instance_data scratch;
+		bind_instance_values(&scratch, clip);
+		clip->bake_bytes -= trk.baked.Size * (int)sizeof(float);
+		float e = bake_track(trk, clip->bake_rate, &scratch);
+		if (e > clip->bake_max_error) clip->bake_max_error = e;
+		clip->bake_bytes += trk.baked.Size * (int)sizeof(float);
+	}
+	clip->key_version = ++g_clip_sys.layout_serial;
+}
+
+// Resolve (clip, track) for an edit; packed clips are copied out of their pack first
+static iam_result edit_target(ImGuiID clip_id, ImGuiID channel, int type, iam_clip_data** out_clip, iam_track** out_trk) {
+	if (type < iam_chan_float || type > iam_chan_color_rel) return iam_err_bad_arg;
+	iam_clip_data* clip = find_clip(clip_id);
+	if (!clip) return iam_err_not_found;
+	materialize_packed_clip(clip);
+	*out_clip = clip;
+	*out_trk = find_edit_track(clip, channel, type);
+	return iam_ok;
+}
+
+// Resolve a track for a key query; packed tracks are read in place (nullptr if the track does not exist)
+static iam_track const* query_target(ImGuiID clip_id, ImGuiID channel, int type) {
+	if (type < iam_chan_float || type > iam_chan_color_rel) return nullptr;
+	iam_clip_data* clip = find_clip(clip_id);
+	return clip ? find_edit_track(clip, channel, type) : nullptr;
+}
+
+} // namespace iam_clip_detail
+
+iam_result iam_clip_insert_key(ImGuiID clip_id, ImGuiID channel, int type, float time, float const* value, int ease_type, int* out_index) {
+	using namespace iam_clip_detail;
+	if (!value) return iam_err_bad_arg;
+	iam_clip_data* clip; iam_track* trk;
+	iam_result res = edit_target(clip_id, channel, type, &clip, &trk);
+	if (res != iam_ok) return res;
+
+	if (!trk) {
+		// New channel: relative tracks need anchor setup, author those through iam_clip
+		if (type >= iam_chan_float_rel) return iam_err_bad_arg;
+		clip->iam_tracks.push_back(iam_track());
+		trk = &clip->iam_tracks.back();
+		trk->channel = channel;
+		trk->type = type;
+		build_channel_index(clip);  // Layout change: instances re-bind on their next update
+	}
+
+	keyframe k;
+	k.channel = channel;
+	k.type = type;
+	k.time = time;
+	k.ease_type = ease_type;
+	k.color_space = trk->color_space;
+	set_key_value(k, type, value);
+	int lo = 0, hi = trk->keys.Size;
+	while (lo < hi) {
+		int mid = (lo + hi) >> 1;
+		if (trk->keys[mid].time <= time) lo = mid + 1; else hi = mid;
+	}
+	trk->keys.insert(trk->keys.Data + lo, k);
+	commit_key_edit(clip, *trk, -FLT_MAX, time);
+	if (out_index) *out_index = lo;
+	return iam_ok;
+}
+
+iam_result iam_clip_edit_key(ImGuiID clip_id, ImGuiID channel, int type, int key_index, float time, float const* value, int* out_index) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip; iam_track* trk;
+	iam_result res = edit_target(clip_id, channel, type, &clip, &trk);
+	if (res != iam_ok) return res;
+	if (!trk || key_index < 0 || key_index >= trk->keys.Size) return iam_err_not_found;
+
+	keyframe& k = trk->keys[key_index];
+	float old_time = k.time;
+	if (value) set_key_value(k, type, value);
+	k.time = time;
+	int index = time != old_time ? resort_key(trk->keys, key_index) : key_index;
+	commit_key_edit(clip, *trk, old_time, time);
+	if (out_index) *out_index = index;
+	return iam_ok;
+}
+
+iam_result iam_clip_remove_key(ImGuiID clip_id, ImGuiID channel, int type, int key_index) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip; iam_track* trk;
+	iam_result res = edit_target(clip_id, channel, type, &clip, &trk);
+	if (res != iam_ok) return res;
+	if (!trk || key_index < 0 || key_index >= trk->keys.Size) return iam_err_not_found;
+
+	// The track keeps its value slot even when emptied, so the clip layout does not change
+	float old_time = trk->keys[key_index].time;
+	trk->keys.erase(trk->keys.Data + key_index);
+	commit_key_edit(clip, *trk, old_time, -FLT_MAX);
+	return iam_ok;
+}
+
+iam_result iam_clip_set_track_ease(ImGuiID clip_id, ImGuiID channel, int type, int key_index, int ease_type, float const* bezier4) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip; iam_track* trk;
+	iam_result res = edit_target(clip_id, channel, type, &clip, &trk);
+	if (res != iam_ok) return res;
+	if (!trk || key_index < -1 || key_index >= trk->keys.Size) return iam_err_not_found;
+
+	int first = key_index < 0 ? 0 : key_index;
+	int last = key_index < 0 ? trk->keys.Size : key_index + 1;
+	for (int i = first; i < last; ++i) {
+		keyframe& k = trk->keys[i];
+		k.ease_type = ease_type;
+		k.is_spring = false;
+		k.has_bezier = bezier4 != nullptr;
+		if (bezier4) memcpy(k.bezier, bezier4, sizeof(float) * 4);
+	}
+	if (bezier4 && ease_type == iam_ease_cubic_bezier) eval_clip_ease(ease_type, 0.0f, bezier4, true);  // Warm the LUT off the hot path
+	commit_key_edit(clip, *trk, -FLT_MAX, -FLT_MAX);
+	return iam_ok;
+}
+
+int iam_clip_get_key_count(ImGuiID clip_id, ImGuiID channel, int type) {
+	using namespace iam_clip_detail;
+	iam_track const* trk = query_target(clip_id, channel, type);
+	if (!trk) return 0;
+	return trk->packed_count > 0 ? trk->packed_count : trk->keys.Size;
+}
+
+bool iam_clip_get_key(ImGuiID clip_id, ImGuiID channel, int type, int key_index, float* out_time, float* out_value) {
+	using namespace iam_clip_detail;
+	iam_track const* trk = query_target(clip_id, channel, type);
+	if (!trk) return false;
+	int n = track_value_size(type);
+	if (trk->packed_count > 0) {
+		if (key_index < 0 || key_index >= trk->packed_count) return false;
+		float const* values = trk->packed_values + key_index * n;
+		if (out_time) *out_time = trk->packed_times[key_index];
+		if (out_value) {
+			if (type == iam_chan_int) { int i; memcpy(&i, values, sizeof(int)); out_value[0] = (float)i; }
+			else memcpy(out_value, values, sizeof(float) * n);
+		}
+		return true;
+	}
+	if (key_index < 0 || key_index >= trk->keys.Size) return false;
+	keyframe const& k = trk->keys[key_index];
+	if (out_time) *out_time = k.time;
+	if (out_value) {
+		if (type == iam_chan_int) out_value[0] = (float)k.get_int();
+		else memcpy(out_value, k.value, sizeof(float) * (n > 4 ? 4 : n));
+		if (n > 4) memcpy(out_value + 4, k.value_ext, sizeof(float) * (n - 4));
+	}
+	return true;
+}
+
+// ----------------------------------------------------
+// Stateless sampling - evaluate a clip at arbitrary times without an instance
+// ----------------------------------------------------
+
+namespace iam_clip_detail {
+
+// Evaluate every track at t into out (clip->value_count floats); ints are written as float
+static void sample_clip(iam_clip_data const* clip, float t, float const* var_keys, float* out) {
+	for (int tr = 0; tr < clip->iam_tracks.Size; ++tr) {
+		iam_track const& trk = clip->iam_tracks[tr];
+		float* dst = out + trk.value_offset;
+		if (trk.type == iam_chan_int) {
+			int v = 0;
+			memcpy(dst, &v, sizeof(int));
+			eval_track_into(trk, t, var_keys, dst);
+			memcpy(&v, dst, sizeof(int));
+			dst[0] = (float)v;
+		} else {
+			memset(dst, 0, sizeof(float) * track_value_size(trk.type));
+			eval_track_into(trk, t, var_keys, dst);
+		}
+	}
+}
+
+} // namespace iam_clip_detail
+
+int iam_clip_sample_size(ImGuiID clip_id) {
+	using namespace iam_clip_detail;
+	iam_clip_data const* clip = find_clip(clip_id);
+	return clip ? clip->value_count : 0;
+}
+
+int iam_clip_sample_offset(ImGuiID clip_id, ImGuiID channel, int type) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip = find_clip(clip_id);
+	if (!clip) return -1;
+	iam_track const* trk = find_edit_track(clip, channel, type);
+	return trk ? trk->value_offset : -1;
+}
+
+bool iam_clip_sample(ImGuiID clip_id, float time, int loop_index, float* out_values) {
+	return iam_clip_sample_batch(clip_id, &time, 1, loop_index, out_values);
+}
+
+bool iam_clip_sample_batch(ImGuiID clip_id, float const* times, int count, int loop_index, float* out_values) {
+	using namespace iam_clip_detail;
+	if (!times || !out_values || count < 0) return false;
+	iam_clip_data const* clip = find_clip(clip_id);
+	if (!clip) return false;
+
+	// Variations are resolved once for the whole batch from a fixed seed, so results do not depend on call order
+	ImVector<float> var_keys;
+	if (clip->var_value_count > 0) {
+		unsigned int rng_state = 12345u + clip_id;
+		var_keys.resize(clip->var_value_count);
+		resolve_variation_keys(clip, loop_index < 0 ? 0 : loop_index, &rng_state, var_keys.Data);
+	}
+	int stride = clip->value_count;
+	for (int i = 0; i < count; ++i)
+		sample_clip(clip, times[i], var_keys.Data, out_values + i * stride);
+	return true;
+}
+
+bool iam_clip_get_bake_info(ImGuiID clip_id, int* out_bytes, float* out_max_error) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip = find_clip(clip_id);
+	if (!clip || clip->bake_rate <= 0.0f) return false;
+	if (out_bytes) *out_bytes = clip->bake_bytes;
+	if (out_max_error) *out_max_error = clip->bake_max_error;
+	return true;
+}
+
+// Stagger helpers
+float iam_stagger_delay(ImGuiID clip_id, int index) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip = find_clip(clip_id);
+	if (!clip || clip->stagger_count <= 1) return 0.0f;
+
+	int count = clip->stagger_count;
+	float delay = clip->stagger_delay;
+	float bias = clip->stagger_center_bias;
+
+	// Calculate delay based on index and center bias
+	// bias = 0: start from beginning (index 0 has 0 delay)
+	// bias = 1: start from center (center indices have 0 delay, edges have max delay)
+	// bias = 0.5: mixed
+	if (bias <= 0.0f) {
+		// Simple linear stagger from start
+		return (float)index * delay;
+	} else {
+		// Stagger from center
+		float center = (float)(count - 1) * 0.5f;
+		float dist_from_center = fabsf((float)index - center);
+		float max_dist = center;
+		if (max_dist > 0.0f) {
+			float linear_delay = (float)index * delay;
+			float center_delay = dist_from_center * delay * 2.0f / (float)count * (float)(count - 1);
+			return linear_delay * (1.0f - bias) + center_delay * bias;
+		}
+	}
+	return 0.0f;
+}
+
+iam_instance iam_play_stagger(ImGuiID clip_id, ImGuiID instance_id, int index) {
+	using namespace iam_clip_detail;
+	if (!g_clip_sys.initialized) iam_clip_init();
+
+	iam_clip_data* clip = find_clip(clip_id);
 	if (!clip) return iam_instance(0);
 
 	// Play with base delay + stagger delay
@@ -3521,67 +5928,74 @@ void iam_layer_add(iam_instance inst, float weight) {
 
 	g_layer_state.total_weight += weight;
 
-	// Accumulate float values
-	for (int i = 0; i < src->values_float.Data.Size; ++i) {
-		IMGUI_STORAGE_PAIR& p = src->values_float.Data[i];
-		ImGuiID ch = p.key;
-		float val = *(float*)&p.val_i;
-		float acc = g_layer_state.acc_float.GetFloat(ch, 0.0f);
-		float w = g_layer_state.weight_float.GetFloat(ch, 0.0f);
-		g_layer_state.acc_float.SetFloat(ch, acc + val * weight);
-		g_layer_state.weight_float.SetFloat(ch, w + weight);
-	}
-
-	// Accumulate int values
-	for (int i = 0; i < src->values_int.Data.Size; ++i) {
-		IMGUI_STORAGE_PAIR& p = src->values_int.Data[i];
-		ImGuiID ch = p.key;
-		int val = p.val_i;
-		float acc = (float)g_layer_state.acc_int.GetInt(ch, 0);
-		float w = g_layer_state.weight_int.GetFloat(ch, 0.0f);
-		g_layer_state.acc_int.SetInt(ch, (int)(acc + (float)val * weight));
-		g_layer_state.weight_int.SetFloat(ch, w + weight);
-	}
-
-	// Accumulate vec2 values
-	for (int i = 0; i < src->values_vec2.Size; ++i) {
-		iam_instance_data::vec2_entry& e = src->values_vec2[i];
-		// Find or create accumulator entry
-		int found = -1;
-		for (int j = 0; j < g_layer_state.acc_vec2.Size; ++j) {
-			if (g_layer_state.acc_vec2[j].ch == e.ch) { found = j; break; }
-		}
-		if (found < 0) {
-			iam_instance_data::vec2_entry acc_e = { e.ch, ImVec2(0, 0) };
-			iam_instance_data::vec2_entry w_e = { e.ch, ImVec2(0, 0) };
-			g_layer_state.acc_vec2.push_back(acc_e);
-			g_layer_state.weight_vec2.push_back(w_e);
-			found = g_layer_state.acc_vec2.Size - 1;
-		}
-		g_layer_state.acc_vec2[found].v.x += e.v.x * weight;
-		g_layer_state.acc_vec2[found].v.y += e.v.y * weight;
-		g_layer_state.weight_vec2[found].v.x += weight;
-	}
-
-	// Accumulate vec4 values
-	for (int i = 0; i < src->values_vec4.Size; ++i) {
-		iam_instance_data::vec4_entry& e = src->values_vec4[i];
-		int found = -1;
-		for (int j = 0; j < g_layer_state.acc_vec4.Size; ++j) {
-			if (g_layer_state.acc_vec4[j].ch == e.ch) { found = j; break; }
-		}
-		if (found < 0) {
-			iam_instance_data::vec4_entry acc_e = { e.ch, ImVec4(0, 0, 0, 0) };
-			iam_instance_data::vec4_entry w_e = { e.ch, ImVec4(0, 0, 0, 0) };
-			g_layer_state.acc_vec4.push_back(acc_e);
-			g_layer_state.weight_vec4.push_back(w_e);
-			found = g_layer_state.acc_vec4.Size - 1;
-		}
-		g_layer_state.acc_vec4[found].v.x += e.v.x * weight;
-		g_layer_state.acc_vec4[found].v.y += e.v.y * weight;
-		g_layer_state.acc_vec4[found].v.z += e.v.z * weight;
-		g_layer_state.acc_vec4[found].v.w += e.v.w * weight;
-		g_layer_state.weight_vec4[found].v.x += weight;
+	iam_clip_data* clip = find_clip(src->clip_id);
+	if (!clip || src->values_layout != clip->layout_version) return;
+	resolve_instance_tracks(src, clip);
+
+	// Walk the clip's tracks; values come straight from the instance value block.
+	// Relative float/vec2 tracks are layered unresolved (percent, px_bias) through the vec2/vec4 accumulators.
+	for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+		iam_track const& trk = clip->iam_tracks[t];
+		float const* v = src->values.Data + trk.value_offset;
+		ImGuiID ch = trk.channel;
+		switch (trk.type) {
+			case iam_chan_float: {
+				float acc = g_layer_state.acc_float.GetFloat(ch, 0.0f);
+				float w = g_layer_state.weight_float.GetFloat(ch, 0.0f);
+				g_layer_state.acc_float.SetFloat(ch, acc + v[0] * weight);
+				g_layer_state.weight_float.SetFloat(ch, w + weight);
+				break;
+			}
+			case iam_chan_int: {
+				int val; memcpy(&val, v, sizeof(int));
+				float acc = (float)g_layer_state.acc_int.GetInt(ch, 0);
+				float w = g_layer_state.weight_int.GetFloat(ch, 0.0f);
+				g_layer_state.acc_int.SetInt(ch, (int)(acc + (float)val * weight));
+				g_layer_state.weight_int.SetFloat(ch, w + weight);
+				break;
+			}
+			case iam_chan_vec2:
+			case iam_chan_float_rel: {
+				// Find or create accumulator entry
+				int found = -1;
+				for (int j = 0; j < g_layer_state.acc_vec2.Size; ++j) {
+					if (g_layer_state.acc_vec2[j].ch == ch) { found = j; break; }
+				}
+				if (found < 0) {
+					iam_instance_data::vec2_entry acc_e = { ch, ImVec2(0, 0) };
+					iam_instance_data::vec2_entry w_e = { ch, ImVec2(0, 0) };
+					g_layer_state.acc_vec2.push_back(acc_e);
+					g_layer_state.weight_vec2.push_back(w_e);
+					found = g_layer_state.acc_vec2.Size - 1;
+				}
+				g_layer_state.acc_vec2[found].v.x += v[0] * weight;
+				g_layer_state.acc_vec2[found].v.y += v[1] * weight;
+				g_layer_state.weight_vec2[found].v.x += weight;
+				break;
+			}
+			case iam_chan_vec4:
+			case iam_chan_vec2_rel: {
+				int found = -1;
+				for (int j = 0; j < g_layer_state.acc_vec4.Size; ++j) {
+					if (g_layer_state.acc_vec4[j].ch == ch) { found = j; break; }
+				}
+				if (found < 0) {
+					iam_instance_data::vec4_entry acc_e = { ch, ImVec4(0, 0, 0, 0) };
+					iam_instance_data::vec4_entry w_e = { ch, ImVec4(0, 0, 0, 0) };
+					g_layer_state.acc_vec4.push_back(acc_e);
+					g_layer_state.weight_vec4.push_back(w_e);
+					found = g_layer_state.acc_vec4.Size - 1;
+				}
+				g_layer_state.acc_vec4[found].v.x += v[0] * weight;
+				g_layer_state.acc_vec4[found].v.y += v[1] * weight;
+				g_layer_state.acc_vec4[found].v.z += v[2] * weight;
+				g_layer_state.acc_vec4[found].v.w += v[3] * weight;
+				g_layer_state.weight_vec4[found].v.x += weight;
+				break;
+			}
+			default:
+				break;  // Colors and wide relative tracks are not layered
+		}
 	}
 }
 
@@ -3674,184 +6088,2092 @@ bool iam_get_blended_vec4(ImGuiID instance_id, ImGuiID channel, ImVec4* out) {
 			return true;
 		}
 	}
-	return false;
+	return false;
+}
+
+bool iam_get_blended_int(ImGuiID instance_id, ImGuiID channel, int* out) {
+	using namespace iam_clip_detail;
+	iam_instance_data* inst = find_instance(instance_id);
+	if (!inst || !inst->has_blended || !out) return false;
+	for (int i = 0; i < inst->blended_int.Data.Size; ++i) {
+		if (inst->blended_int.Data[i].key == channel) {
+			*out = inst->blended_int.Data[i].val_i;
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------
+// Blend graphs
+// ----------------------------------------------------
+
+namespace iam_clip_detail {
+
+static iam_blend_graph* find_blend_graph(ImGuiID graph_id) {
+	int idx = g_clip_sys.graph_map.GetInt(graph_id, 0);
+	return idx > 0 ? g_clip_sys.graphs[idx - 1] : nullptr;
+}
+
+// Clip whose value block a source node can read this frame, or nullptr (missing, loading, instanced or not evaluated yet)
+static iam_clip_data* blend_source_clip(iam_blend_node const& node, iam_instance_data** out_inst) {
+	iam_instance_data* inst = find_instance(node.instance_id);
+	*out_inst = inst;
+	if (!inst || inst->lane_count > 0) return nullptr;
+	iam_clip_data* clip = find_clip(inst->clip_id);
+	if (!clip || inst->values_layout != clip->layout_version) return nullptr;
+	return clip;
+}
+
+// Component holding the hue of a color space, or -1
+static int color_hue_index(int color_space) {
+	if (color_space == iam_col_hsv) return 0;
+	if (color_space == iam_col_oklch) return 2;
+	return -1;
+}
+
+// a = lerp(a, b, t); hue components take the shortest way around the circle
+static void blend_slot_lerp(iam_blend_slot const& slot, float* a, float const* b, float t) {
+	int hue = (slot.type == iam_chan_color) ? color_hue_index(slot.color_space) : -1;
+	float h = 0.0f;
+	if (hue >= 0) h = a[hue] + (ImFmod(b[hue] - a[hue] + 1.5f, 1.0f) - 0.5f) * t;
+	for (int c = 0; c < slot.comps; ++c)
+		a[c] += (b[c] - a[c]) * t;
+	if (hue >= 0) a[hue] = h - ImFloor(h);
+}
+
+// a += b * w; hue components wrap
+static void blend_slot_add(iam_blend_slot const& slot, float* a, float const* b, float w) {
+	for (int c = 0; c < slot.comps; ++c)
+		a[c] += b[c] * w;
+	int hue = (slot.type == iam_chan_color) ? color_hue_index(slot.color_space) : -1;
+	if (hue >= 0) a[hue] -= ImFloor(a[hue]);
+}
+
+// Bind channels to value slots: one slot per (channel, kind) across every source, track maps per source node
+// and override masks as slot flags. Runs when the graph is built and when a source changes clip layout.
+static void resolve_blend_graph(iam_blend_graph* g) {
+	g->slots.resize(0);
+	g->slot_index.Clear();
+	g->track_slot.resize(0);
+	g->value_count = 0;
+	for (int n = 0; n < g->nodes.Size; ++n) {
+		iam_blend_node& node = g->nodes[n];
+		if (node.kind != blend_node_source) continue;
+		node.map_begin = g->track_slot.Size;
+		node.map_count = 0;
+		node.clip_id = 0;
+		node.layout_version = 0;
+		iam_instance_data* inst;
+		iam_clip_data* clip = blend_source_clip(node, &inst);
+		if (!clip) continue;
+		node.clip_id = clip->id;
+		node.layout_version = clip->layout_version;
+		node.map_count = clip->iam_tracks.Size;
+		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+			iam_track const& trk = clip->iam_tracks[t];
+			ImGuiID key = channel_key(trk.channel, track_value_kind(trk.type));
+			int s = g->slot_index.GetInt(key, 0) - 1;
+			if (s < 0) {
+				iam_blend_slot slot = { trk.channel, trk.type, g->value_count, track_value_size(trk.type), trk.color_space, trk.anchor_space, trk.anchor_axis };
+				g->value_count += slot.comps;
+				g->slots.push_back(slot);
+				s = g->slots.Size - 1;
+				g->slot_index.SetInt(key, s + 1);
+			} else if (g->slots[s].type != trk.type) {
+				s = -1;  // Same channel with a different layout (e.g. absolute vs relative): not blended
+			}
+			g->track_slot.push_back(s);
+		}
+	}
+
+	int slot_count = g->slots.Size;
+	g->masks.resize(0);
+	for (int n = 0; n < g->nodes.Size; ++n) {
+		iam_blend_node& node = g->nodes[n];
+		if (node.kind != blend_node_override || node.mask_channel_count == 0) { node.mask_begin = -1; continue; }
+		node.mask_begin = g->masks.Size;
+		g->masks.resize(g->masks.Size + slot_count);
+		unsigned char* mask = g->masks.Data + node.mask_begin;
+		for (int s = 0; s < slot_count; ++s) {
+			mask[s] = 0;
+			for (int m = 0; m < node.mask_channel_count; ++m)
+				if (g->mask_channels[node.mask_channel_begin + m] == g->slots[s].channel) { mask[s] = 1; break; }
+		}
+	}
+
+	g->values.resize(g->nodes.Size * g->value_count);
+	g->present.resize(g->nodes.Size * slot_count);
+	g->acc_weight.resize(slot_count);
+	g->output.resize(g->value_count);
+	g->output_present.resize(slot_count);
+	if (slot_count > 0) memset(g->output_present.Data, 0, (size_t)slot_count);
+}
+
+// Evaluate every node in order over flat value blocks; the last node becomes the graph output
+static void eval_blend_graph(iam_blend_graph* g) {
+	if (!g->valid || g->nodes.Size == 0) return;
+
+	// Rebind when a source now plays another clip or its clip was rebuilt
+	for (int n = 0; n < g->nodes.Size; ++n) {
+		iam_blend_node const& node = g->nodes[n];
+		if (node.kind != blend_node_source) continue;
+		iam_instance_data* inst;
+		iam_clip_data* clip = blend_source_clip(node, &inst);
+		if ((clip ? clip->id : 0) != node.clip_id || (clip ? clip->layout_version : 0) != node.layout_version) {
+			resolve_blend_graph(g);
+			break;
+		}
+	}
+
+	int value_count = g->value_count, slot_count = g->slots.Size;
+	if (slot_count == 0) return;
+	for (int n = 0; n < g->nodes.Size; ++n) {
+		iam_blend_node const& node = g->nodes[n];
+		float* out = g->values.Data + n * value_count;
+		unsigned char* pres = g->present.Data + n * slot_count;
+		memset(pres, 0, (size_t)slot_count);
+		switch (node.kind) {
+			case blend_node_source: {
+				iam_instance_data* inst;
+				iam_clip_data* clip = blend_source_clip(node, &inst);
+				if (!clip) break;
+				for (int t = 0; t < node.map_count; ++t) {
+					int s = g->track_slot[node.map_begin + t];
+					if (s < 0) continue;
+					iam_blend_slot const& slot = g->slots[s];
+					float tmp[8];
+					float const* src = track_read_values(inst, clip, t, tmp);
+					float* dst = out + slot.offset;
+					if (slot.type == iam_chan_int) {
+						int v;
+						memcpy(&v, src, sizeof(int));
+						dst[0] = (float)v;
+					} else if (slot.type == iam_chan_color) {
+						ImVec4 c = iam_detail::color::to_space(ImVec4(src[0], src[1], src[2], src[3]), slot.color_space);
+						dst[0] = c.x; dst[1] = c.y; dst[2] = c.z; dst[3] = c.w;
+					} else {
+						memcpy(dst, src, sizeof(float) * slot.comps);
+					}
+					pres[s] = 1;
+				}
+				break;
+			}
+			case blend_node_blend: {
+				// Running weighted average: each input moves the result by w / accumulated weight
+				float* acc = g->acc_weight.Data;
+				memset(acc, 0, sizeof(float) * slot_count);
+				for (int i = 0; i < node.input_count; ++i) {
+					int in = g->inputs[node.input_begin + i];
+					float w = g->nodes[in].weight;
+					if (w <= 0.0f) continue;
+					float const* in_values = g->values.Data + in * value_count;
+					unsigned char const* in_pres = g->present.Data + in * slot_count;
+					for (int s = 0; s < slot_count; ++s) {
+						if (!in_pres[s]) continue;
+						iam_blend_slot const& slot = g->slots[s];
+						acc[s] += w;
+						if (!pres[s]) {
+							memcpy(out + slot.offset, in_values + slot.offset, sizeof(float) * slot.comps);
+							pres[s] = 1;
+						} else {
+							blend_slot_lerp(slot, out + slot.offset, in_values + slot.offset, w / acc[s]);
+						}
+					}
+				}
+				break;
+			}
+			case blend_node_additive:
+			case blend_node_override: {
+				int base = g->inputs[node.input_begin], layer = g->inputs[node.input_begin + 1];
+				memcpy(out, g->values.Data + base * value_count, sizeof(float) * value_count);
+				memcpy(pres, g->present.Data + base * slot_count, (size_t)slot_count);
+				float w = g->nodes[layer].weight;
+				if (w <= 0.0f) break;
+				float const* layer_values = g->values.Data + layer * value_count;
+				unsigned char const* layer_pres = g->present.Data + layer * slot_count;
+				unsigned char const* mask = (node.mask_begin >= 0) ? g->masks.Data + node.mask_begin : nullptr;
+				for (int s = 0; s < slot_count; ++s) {
+					if (!layer_pres[s] || (mask && !mask[s])) continue;
+					iam_blend_slot const& slot = g->slots[s];
+					float* dst = out + slot.offset;
+					float const* src = layer_values + slot.offset;
+					if (node.kind == blend_node_additive) {
+						if (!pres[s]) { memset(dst, 0, sizeof(float) * slot.comps); pres[s] = 1; }
+						blend_slot_add(slot, dst, src, w);
+					} else if (!pres[s]) {
+						memcpy(dst, src, sizeof(float) * slot.comps);  // Channel only on the layer: take it as is
+						pres[s] = 1;
+					} else {
+						blend_slot_lerp(slot, dst, src, w);
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	// Output: last node, colors back to sRGB
+	int last = g->nodes.Size - 1;
+	memcpy(g->output.Data, g->values.Data + last * value_count, sizeof(float) * value_count);
+	memcpy(g->output_present.Data, g->present.Data + last * slot_count, (size_t)slot_count);
+	for (int s = 0; s < slot_count; ++s) {
+		iam_blend_slot const& slot = g->slots[s];
+		if (!g->output_present[s] || slot.type != iam_chan_color) continue;
+		float* v = g->output.Data + slot.offset;
+		ImVec4 c = iam_detail::color::from_space(ImVec4(v[0], v[1], v[2], v[3]), slot.color_space);
+		v[0] = c.x; v[1] = c.y; v[2] = c.z; v[3] = c.w;
+	}
+}
+
+// Append a node to the graph being built; inputs must name earlier nodes
+static int add_blend_node(int kind, float weight, ImGuiID instance_id, int const* inputs, int input_count) {
+	iam_blend_graph* g = g_clip_sys.graph_build;
+	if (!g) return -1;
+	for (int i = 0; i < input_count; ++i) {
+		if (inputs[i] < 0 || inputs[i] >= g->nodes.Size) {
+			g->valid = false;
+			return -1;
+		}
+	}
+	iam_blend_node node;
+	memset(&node, 0, sizeof(node));
+	node.kind = kind;
+	node.weight = weight;
+	node.instance_id = instance_id;
+	node.input_begin = g->inputs.Size;
+	node.input_count = input_count;
+	node.mask_begin = -1;
+	for (int i = 0; i < input_count; ++i)
+		g->inputs.push_back(inputs[i]);
+	g->nodes.push_back(node);
+	return g->nodes.Size - 1;
+}
+
+// Slot answering to (channel, kind) in a graph's current output, or -1
+static int blend_graph_slot(ImGuiID graph_id, ImGuiID channel, int kind, iam_blend_graph** out_graph) {
+	iam_blend_graph* g = find_blend_graph(graph_id);
+	*out_graph = g;
+	if (!g || !g->valid) return -1;
+	int s = g->slot_index.GetInt(channel_key(channel, kind), 0) - 1;
+	if (s < 0 || s >= g->output_present.Size || !g->output_present[s]) return -1;
+	return s;
+}
+
+static bool blend_graph_read(ImGuiID graph_id, ImGuiID channel, int kind, float* out) {
+	iam_blend_graph* g;
+	int s = blend_graph_slot(graph_id, channel, kind, &g);
+	if (s < 0) return false;
+	iam_blend_slot const& slot = g->slots[s];
+	read_slot_value(slot.type, slot.anchor_space, slot.anchor_axis, g->output.Data + slot.offset, out);
+	return true;
+}
+
+} // namespace iam_clip_detail
+
+void iam_blend_graph_begin(ImGuiID graph_id) {
+	using namespace iam_clip_detail;
+	if (!g_clip_sys.initialized) iam_clip_init();
+	iam_blend_graph* g = find_blend_graph(graph_id);
+	if (!g) {
+		g = IM_NEW(iam_blend_graph)();
+		g->id = graph_id;
+		g_clip_sys.graphs.push_back(g);
+		g_clip_sys.graph_map.SetInt(graph_id, g_clip_sys.graphs.Size);
+	}
+	g->nodes.resize(0);
+	g->inputs.resize(0);
+	g->mask_channels.resize(0);
+	g->valid = true;
+	g_clip_sys.graph_build = g;
+}
+
+int iam_blend_graph_source(ImGuiID instance_id, float weight) {
+	return iam_clip_detail::add_blend_node(iam_clip_detail::blend_node_source, weight, instance_id, nullptr, 0);
+}
+
+int iam_blend_graph_blend(int const* inputs, int count, float weight) {
+	using namespace iam_clip_detail;
+	if (!inputs || count <= 0) {
+		if (g_clip_sys.graph_build) g_clip_sys.graph_build->valid = false;
+		return -1;
+	}
+	return add_blend_node(blend_node_blend, weight, 0, inputs, count);
+}
+
+int iam_blend_graph_additive(int base, int layer, float weight) {
+	int inputs[2] = { base, layer };
+	return iam_clip_detail::add_blend_node(iam_clip_detail::blend_node_additive, weight, 0, inputs, 2);
+}
+
+int iam_blend_graph_override(int base, int layer, ImGuiID const* channels, int channel_count, float weight) {
+	using namespace iam_clip_detail;
+	int inputs[2] = { base, layer };
+	int node = add_blend_node(blend_node_override, weight, 0, inputs, 2);
+	if (node < 0) return -1;
+	iam_blend_graph* g = g_clip_sys.graph_build;
+	g->nodes[node].mask_channel_begin = g->mask_channels.Size;
+	g->nodes[node].mask_channel_count = channels ? ImMax(channel_count, 0) : 0;
+	for (int i = 0; i < g->nodes[node].mask_channel_count; ++i)
+		g->mask_channels.push_back(channels[i]);
+	return node;
+}
+
+void iam_blend_graph_end() {
+	using namespace iam_clip_detail;
+	iam_blend_graph* g = g_clip_sys.graph_build;
+	g_clip_sys.graph_build = nullptr;
+	if (!g) return;
+	resolve_blend_graph(g);
+	eval_blend_graph(g);
+}
+
+void iam_blend_graph_set_weight(ImGuiID graph_id, int node, float weight) {
+	using namespace iam_clip_detail;
+	iam_blend_graph* g = find_blend_graph(graph_id);
+	if (!g || node < 0 || node >= g->nodes.Size) return;
+	g->nodes[node].weight = weight;
+}
+
+void iam_blend_graph_evaluate(ImGuiID graph_id) {
+	using namespace iam_clip_detail;
+	iam_blend_graph* g = find_blend_graph(graph_id);
+	if (g && g != g_clip_sys.graph_build) eval_blend_graph(g);
+}
+
+void iam_blend_graph_destroy(ImGuiID graph_id) {
+	using namespace iam_clip_detail;
+	int idx = g_clip_sys.graph_map.GetInt(graph_id, 0) - 1;
+	if (idx < 0) return;
+	iam_blend_graph* g = g_clip_sys.graphs[idx];
+	if (g_clip_sys.graph_build == g) g_clip_sys.graph_build = nullptr;
+	IM_DELETE(g);
+	int last = g_clip_sys.graphs.Size - 1;
+	if (idx != last) {
+		g_clip_sys.graphs[idx] = g_clip_sys.graphs[last];
+		g_clip_sys.graph_map.SetInt(g_clip_sys.graphs[idx]->id, idx + 1);
+	}
+	g_clip_sys.graphs.pop_back();
+	g_clip_sys.graph_map.SetInt(graph_id, 0);
+}
+
+bool iam_blend_graph_get_float(ImGuiID graph_id, ImGuiID channel, float* out) {
+	if (!out) return false;
+	return iam_clip_detail::blend_graph_read(graph_id, channel, iam_chan_float, out);
+}
+
+bool iam_blend_graph_get_vec2(ImGuiID graph_id, ImGuiID channel, ImVec2* out) {
+	if (!out) return false;
+	float v[2];
+	if (!iam_clip_detail::blend_graph_read(graph_id, channel, iam_chan_vec2, v)) return false;
+	*out = ImVec2(v[0], v[1]);
+	return true;
+}
+
+bool iam_blend_graph_get_vec4(ImGuiID graph_id, ImGuiID channel, ImVec4* out) {
+	if (!out) return false;
+	float v[4];
+	if (!iam_clip_detail::blend_graph_read(graph_id, channel, iam_chan_vec4, v)) return false;
+	*out = ImVec4(v[0], v[1], v[2], v[3]);
+	return true;
+}
+
+bool iam_blend_graph_get_color(ImGuiID graph_id, ImGuiID channel, ImVec4* out) {
+	if (!out) return false;
+	float v[4];
+	if (!iam_clip_detail::blend_graph_read(graph_id, channel, iam_chan_color, v)) return false;
+	*out = ImVec4(v[0], v[1], v[2], v[3]);
+	return true;
+}
+
+bool iam_blend_graph_get_int(ImGuiID graph_id, ImGuiID channel, int* out) {
+	using namespace iam_clip_detail;
+	iam_blend_graph* g;
+	int s = blend_graph_slot(graph_id, channel, iam_chan_int, &g);
+	if (s < 0 || !out) return false;
+	*out = (int)ImFloor(g->output[g->slots[s].offset] + 0.5f);
+	return true;
+}
+
+// ----------------------------------------------------
+// State machines
+// ----------------------------------------------------
+
+namespace iam_clip_detail {
+
+static iam_state_machine* find_state_machine(ImGuiID machine_id) {
+	int idx = g_clip_sys.machine_map.GetInt(machine_id, 0);
+	return idx > 0 ? g_clip_sys.machines[idx - 1] : nullptr;
+}
+
+static iam_sm_player* find_sm_player(ImGuiID player_id) {
+	int idx = g_clip_sys.player_map.GetInt(player_id, 0);
+	return idx > 0 ? g_clip_sys.players[idx - 1] : nullptr;
+}
+
+static ImGuiID sm_instance_id(ImGuiID player_id, ImGuiID state_id) {
+	return ImHashData(&state_id, sizeof(state_id), player_id);
+}
+
+static void sm_destroy_instance(ImGuiID inst_id) {
+	iam_instance_data* inst = find_instance(inst_id);
+	if (inst) free_instance(inst);
+}
+
+// Instance weights follow the crossfade, so reads (and iam_layer_add users) see the blend
+static void sm_apply_weights(iam_sm_player* p) {
+	iam_instance_data* cur = find_instance(p->inst_id);
+	if (cur) cur->weight = p->fade;
+	iam_instance_data* prev = p->prev_state_id ? find_instance(p->prev_inst_id) : nullptr;
+	if (prev) prev->weight = 1.0f - p->fade;
+}
+
+static void sm_start_fade(iam_sm_player* p, float duration) {
+	p->fade_duration = duration;
+	if (duration <= 0.0f) {
+		if (p->prev_state_id) sm_destroy_instance(p->prev_inst_id);
+		p->prev_state_id = 0;
+		p->prev_inst_id = 0;
+		p->fade = 1.0f;
+	} else {
+		bool listed = false;
+		for (int i = 0; i < g_clip_sys.players_fading.Size && !listed; ++i)
+			listed = g_clip_sys.players_fading[i] == p->id;
+		if (!listed) g_clip_sys.players_fading.push_back(p->id);
+	}
+	sm_apply_weights(p);
+}
+
+// Switch a player to a state. Going back to the state it is fading out of reverses the fade (nothing restarts);
+// otherwise the state's clip starts and any older outgoing state is dropped.
+static void sm_enter_state(iam_sm_player* p, iam_state_machine const* m, int state, float crossfade) {
+	iam_sm_state const& st = m->states[state];
+	if (p->prev_state_id != 0 && p->prev_state_id == st.id) {
+		ImSwap(p->state_id, p->prev_state_id);
+		ImSwap(p->inst_id, p->prev_inst_id);
+		p->fade = 1.0f - p->fade;
+		sm_start_fade(p, crossfade);  // Same rate: the way back takes the share of crossfade already faded
+		return;
+	}
+	if (p->prev_state_id != 0) sm_destroy_instance(p->prev_inst_id);
+	p->prev_state_id = p->state_id;
+	p->prev_inst_id = p->inst_id;
+	p->state_id = st.id;
+	p->inst_id = sm_instance_id(p->id, st.id);
+	p->fade = p->prev_state_id ? 0.0f : 1.0f;
+	iam_play(st.clip_id, p->inst_id);
+	iam_instance_data* inst = find_instance(p->inst_id);
+	if (inst) inst->sm_player_id = p->id;
+	sm_start_fade(p, p->prev_state_id ? crossfade : 0.0f);
+}
+
+static bool sm_condition_met(iam_sm_player const* p, iam_sm_cond const& c, ImGuiID trigger) {
+	float v = p->params.GetFloat(c.param, 0.0f);
+	switch (c.op) {
+		case iam_sm_eq: return v == c.value;
+		case iam_sm_ne: return v != c.value;
+		case iam_sm_gt: return v > c.value;
+		case iam_sm_lt: return v < c.value;
+		case iam_sm_ge: return v >= c.value;
+		case iam_sm_le: return v <= c.value;
+		case iam_sm_trigger: return trigger != 0 && c.param == trigger;
+		case iam_sm_complete: {
+			iam_instance_data const* inst = find_instance(p->inst_id);
+			return !inst || (!inst->playing && !inst->pending_load);
+		}
+		default: return false;
+	}
+}
+
+// Take transitions until none matches (at most one per state, so cycles settle). A trigger is consumed by the
+// first transition that uses it and dropped otherwise.
+static void sm_evaluate(iam_sm_player* p, ImGuiID trigger) {
+	iam_state_machine const* m = find_state_machine(p->machine_id);
+	if (!m) return;
+	for (int step = 0; step < m->states.Size; ++step) {
+		int cur = m->state_index.GetInt(p->state_id, 0) - 1;
+		int taken = -1;
+		bool used_trigger = false;
+		for (int t = 0; t < m->transitions.Size && taken < 0; ++t) {
+			iam_sm_transition const& tr = m->transitions[t];
+			if (tr.to < 0 || tr.to == cur || (tr.from >= 0 && tr.from != cur)) continue;
+			bool met = true;
+			bool uses_trigger = false;
+			for (int c = 0; c < tr.cond_count && met; ++c) {
+				iam_sm_cond const& cond = m->conds[tr.cond_begin + c];
+				met = sm_condition_met(p, cond, trigger);
+				uses_trigger |= cond.op == iam_sm_trigger;
+			}
+			if (met) { taken = t; used_trigger = uses_trigger; }
+		}
+		if (taken < 0) break;
+		if (used_trigger) trigger = 0;
+		sm_enter_state(p, m, m->transitions[taken].to, m->transitions[taken].crossfade);
+	}
+}
+
+static void free_sm_player(int idx) {
+	iam_sm_player* p = g_clip_sys.players[idx];
+	sm_destroy_instance(p->inst_id);
+	if (p->prev_state_id) sm_destroy_instance(p->prev_inst_id);
+	ImGuiID id = p->id;
+	IM_DELETE(p);
+	int last = g_clip_sys.players.Size - 1;
+	if (idx != last) {
+		g_clip_sys.players[idx] = g_clip_sys.players[last];
+		g_clip_sys.player_map.SetInt(g_clip_sys.players[idx]->id, idx + 1);
+	}
+	g_clip_sys.players.pop_back();
+	g_clip_sys.player_map.SetInt(id, 0);
+}
+
+// Keep a player's instances from iam_clip_gc while the widget still uses it
+static void sm_touch(iam_sm_player* p) {
+	p->last_seen_frame = g_clip_sys.frame_counter;
+	iam_instance_data* inst = find_instance(p->inst_id);
+	if (inst) inst->last_seen_frame = g_clip_sys.frame_counter;
+}
+
+// Called by iam_clip_update: crossfade progress, then completion transitions (their fades start next update)
+static void update_state_machines(float dt) {
+	for (int i = 0; i < g_clip_sys.players_fading.Size; ) {
+		iam_sm_player* p = find_sm_player(g_clip_sys.players_fading[i]);
+		if (p && p->prev_state_id != 0) {
+			p->fade = p->fade_duration > 0.0f ? ImMin(p->fade + dt / p->fade_duration, 1.0f) : 1.0f;
+			if (p->fade >= 1.0f) {
+				sm_destroy_instance(p->prev_inst_id);
+				p->prev_state_id = 0;
+				p->prev_inst_id = 0;
+			}
+			sm_apply_weights(p);
+		}
+		if (p && p->prev_state_id != 0) { ++i; continue; }
+		g_clip_sys.players_fading[i] = g_clip_sys.players_fading.back();
+		g_clip_sys.players_fading.pop_back();
+	}
+
+	for (int i = 0; i < g_clip_sys.players_dirty.Size; ++i) {
+		iam_sm_player* p = find_sm_player(g_clip_sys.players_dirty[i]);
+		if (p) sm_evaluate(p, 0);
+	}
+	g_clip_sys.players_dirty.resize(0);
+}
+
+// Read a channel from a player: the current state's instance, blended with the outgoing one during a crossfade
+static bool sm_read(ImGuiID player_id, ImGuiID channel, int type, float* out, int color_space) {
+	iam_sm_player* p = find_sm_player(player_id);
+	if (!p) return false;
+	sm_touch(p);
+	float a[4] = { 0, 0, 0, 0 }, b[4] = { 0, 0, 0, 0 };
+	iam_instance cur = iam_get_instance(p->inst_id);
+	bool has_a = false, has_b = false;
+	float wa = 1.0f, wb = 0.0f;
+	if (iam_instance_data const* inst = find_instance(p->inst_id)) wa = inst->weight;
+	if (p->prev_state_id != 0) {
+		iam_instance prev = iam_get_instance(p->prev_inst_id);
+		if (iam_instance_data const* inst = find_instance(p->prev_inst_id)) wb = inst->weight;
+		switch (type) {
+			case iam_chan_float: has_b = prev.get_float(channel, b); break;
+			case iam_chan_vec2: has_b = prev.get_vec2(channel, (ImVec2*)b); break;
+			case iam_chan_vec4: has_b = prev.get_vec4(channel, (ImVec4*)b); break;
+			case iam_chan_color: has_b = prev.get_color(channel, (ImVec4*)b, color_space); break;
+			case iam_chan_int: { int v; has_b = prev.get_int(channel, &v); b[0] = (float)v; break; }
+		}
+	}
+	switch (type) {
+		case iam_chan_float: has_a = cur.get_float(channel, a); break;
+		case iam_chan_vec2: has_a = cur.get_vec2(channel, (ImVec2*)a); break;
+		case iam_chan_vec4: has_a = cur.get_vec4(channel, (ImVec4*)a); break;
+		case iam_chan_color: has_a = cur.get_color(channel, (ImVec4*)a, color_space); break;
+		case iam_chan_int: { int v; has_a = cur.get_int(channel, &v); a[0] = (float)v; break; }
+	}
+	if (!has_a && !has_b) return false;
+	if (!has_b || wb <= 0.0f) { memcpy(out, a, sizeof(a)); return has_a; }
+	if (!has_a) { memcpy(out, b, sizeof(b)); return true; }
+	float t = wa + wb > 0.0f ? wa / (wa + wb) : 1.0f;
+	if (type == iam_chan_color) {
+		ImVec4 c = iam_get_blended_color(ImVec4(b[0], b[1], b[2], b[3]), ImVec4(a[0], a[1], a[2], a[3]), t, color_space);
+		out[0] = c.x; out[1] = c.y; out[2] = c.z; out[3] = c.w;
+	} else {
+		for (int i = 0; i < 4; ++i) out[i] = b[i] + (a[i] - b[i]) * t;
+	}
+	return true;
+}
+
+} // namespace iam_clip_detail
+
+void iam_state_machine_begin(ImGuiID machine_id) {
+	using namespace iam_clip_detail;
+	if (!g_clip_sys.initialized) iam_clip_init();
+	iam_state_machine* m = find_state_machine(machine_id);
+	if (!m) {
+		m = IM_NEW(iam_state_machine)();
+		m->id = machine_id;
+		g_clip_sys.machines.push_back(m);
+		g_clip_sys.machine_map.SetInt(machine_id, g_clip_sys.machines.Size);
+	}
+	m->states.resize(0);
+	m->transitions.resize(0);
+	m->conds.resize(0);
+	m->state_index.Clear();
+	g_clip_sys.machine_build = m;
+}
+
+void iam_state_machine_state(ImGuiID state_id, ImGuiID clip_id) {
+	using namespace iam_clip_detail;
+	iam_state_machine* m = g_clip_sys.machine_build;
+	if (!m || state_id == 0 || m->state_index.GetInt(state_id, 0) != 0) return;
+	iam_sm_state st = { state_id, clip_id };
+	m->states.push_back(st);
+	m->state_index.SetInt(state_id, m->states.Size);
+}
+
+void iam_state_machine_transition(ImGuiID from_state, ImGuiID to_state, ImGuiID param, int condition, float value, float crossfade) {
+	using namespace iam_clip_detail;
+	iam_state_machine* m = g_clip_sys.machine_build;
+	if (!m) return;
+	iam_sm_transition tr = { from_state, to_state, -1, -1, crossfade > 0.0f ? crossfade : 0.0f, m->conds.Size, 0 };
+	m->transitions.push_back(tr);
+	iam_state_machine_condition(param, condition, value);
+}
+
+void iam_state_machine_condition(ImGuiID param, int condition, float value) {
+	using namespace iam_clip_detail;
+	iam_state_machine* m = g_clip_sys.machine_build;
+	if (!m || m->transitions.Size == 0) return;
+	iam_sm_cond c = { param, condition, value };
+	m->conds.push_back(c);
+	m->transitions.back().cond_count++;
+}
+
+void iam_state_machine_end() {
+	using namespace iam_clip_detail;
+	iam_state_machine* m = g_clip_sys.machine_build;
+	g_clip_sys.machine_build = nullptr;
+	if (!m) return;
+	for (int t = 0; t < m->transitions.Size; ++t) {
+		iam_sm_transition& tr = m->transitions[t];
+		tr.from = tr.from_id ? m->state_index.GetInt(tr.from_id, 0) - 1 : -1;
+		tr.to = m->state_index.GetInt(tr.to_id, 0) - 1;
+		if (tr.from_id && tr.from < 0) tr.to = -1;  // Unknown source state: never taken
+	}
+}
+
+void iam_state_machine_destroy(ImGuiID machine_id) {
+	using namespace iam_clip_detail;
+	int idx = g_clip_sys.machine_map.GetInt(machine_id, 0) - 1;
+	if (idx < 0) return;
+	iam_state_machine* m = g_clip_sys.machines[idx];
+	if (g_clip_sys.machine_build == m) g_clip_sys.machine_build = nullptr;
+	IM_DELETE(m);
+	int last = g_clip_sys.machines.Size - 1;
+	if (idx != last) {
+		g_clip_sys.machines[idx] = g_clip_sys.machines[last];
+		g_clip_sys.machine_map.SetInt(g_clip_sys.machines[idx]->id, idx + 1);
+	}
+	g_clip_sys.machines.pop_back();
+	g_clip_sys.machine_map.SetInt(machine_id, 0);
+}
+
+iam_result iam_state_machine_play(ImGuiID machine_id, ImGuiID player_id) {
+	using namespace iam_clip_detail;
+	iam_state_machine* m = find_state_machine(machine_id);
+	if (!m || m->states.Size == 0) return iam_err_not_found;
+	iam_sm_player* p = find_sm_player(player_id);
+	if (p && p->machine_id == machine_id) {
+		sm_touch(p);
+		return iam_ok;
+	}
+	if (!p) {
+		p = IM_NEW(iam_sm_player)();
+		p->id = player_id;
+		g_clip_sys.players.push_back(p);
+		g_clip_sys.player_map.SetInt(player_id, g_clip_sys.players.Size);
+	} else {
+		// Switching machines: start over from the new entry state
+		sm_destroy_instance(p->inst_id);
+		if (p->prev_state_id) sm_destroy_instance(p->prev_inst_id);
+		p->state_id = 0;
+		p->prev_state_id = 0;
+		p->params.Clear();
+	}
+	p->machine_id = machine_id;
+	sm_enter_state(p, m, 0, 0.0f);
+	sm_touch(p);
+	sm_evaluate(p, 0);  // Transitions on default parameters
+	return iam_ok;
+}
+
+void iam_state_machine_set_param(ImGuiID player_id, ImGuiID param, float value) {
+	using namespace iam_clip_detail;
+	iam_sm_player* p = find_sm_player(player_id);
+	if (!p) return;
+	sm_touch(p);
+	if (p->params.GetFloat(param, 0.0f) == value) return;
+	p->params.SetFloat(param, value);
+	sm_evaluate(p, 0);
+}
+
+void iam_state_machine_set_bool(ImGuiID player_id, ImGuiID param, bool value) {
+	iam_state_machine_set_param(player_id, param, value ? 1.0f : 0.0f);
+}
+
+void iam_state_machine_trigger(ImGuiID player_id, ImGuiID param) {
+	using namespace iam_clip_detail;
+	iam_sm_player* p = find_sm_player(player_id);
+	if (!p || param == 0) return;
+	sm_touch(p);
+	sm_evaluate(p, param);
+}
+
+ImGuiID iam_state_machine_get_state(ImGuiID player_id) {
+	using namespace iam_clip_detail;
+	iam_sm_player* p = find_sm_player(player_id);
+	return p ? p->state_id : 0;
+}
+
+void iam_state_machine_stop(ImGuiID player_id) {
+	using namespace iam_clip_detail;
+	int idx = g_clip_sys.player_map.GetInt(player_id, 0) - 1;
+	if (idx >= 0) free_sm_player(idx);
+}
+
+bool iam_state_machine_get_float(ImGuiID player_id, ImGuiID channel, float* out) {
+	float v[4];
+	if (!out || !iam_clip_detail::sm_read(player_id, channel, iam_chan_float, v, 0)) return false;
+	*out = v[0];
+	return true;
+}
+
+bool iam_state_machine_get_vec2(ImGuiID player_id, ImGuiID channel, ImVec2* out) {
+	float v[4];
+	if (!out || !iam_clip_detail::sm_read(player_id, channel, iam_chan_vec2, v, 0)) return false;
+	*out = ImVec2(v[0], v[1]);
+	return true;
+}
+
+bool iam_state_machine_get_vec4(ImGuiID player_id, ImGuiID channel, ImVec4* out) {
+	float v[4];
+	if (!out || !iam_clip_detail::sm_read(player_id, channel, iam_chan_vec4, v, 0)) return false;
+	*out = ImVec4(v[0], v[1], v[2], v[3]);
+	return true;
+}
+
+bool iam_state_machine_get_color(ImGuiID player_id, ImGuiID channel, ImVec4* out, int color_space) {
+	float v[4];
+	if (!out || !iam_clip_detail::sm_read(player_id, channel, iam_chan_color, v, color_space)) return false;
+	*out = ImVec4(v[0], v[1], v[2], v[3]);
+	return true;
+}
+
+bool iam_state_machine_get_int(ImGuiID player_id, ImGuiID channel, int* out) {
+	float v[4];
+	if (!out || !iam_clip_detail::sm_read(player_id, channel, iam_chan_int, v, 0)) return false;
+	*out = (int)ImFloor(v[0] + 0.5f);
+	return true;
+}
+
+// ----------------------------------------------------
+// Coroutine scripts (iam_task)
+// ----------------------------------------------------
+
+#ifdef IAM_HAS_COROUTINES
+
+namespace iam_clip_detail {
+
+static bool task_timer_less(iam_task_wait const& a, iam_task_wait const& b) {
+	return a.wake_time < b.wake_time || (a.wake_time == b.wake_time && a.seq < b.seq);
+}
+
+static void task_timer_push(iam_task_wait const& w) {
+	ImVector<iam_task_wait>& heap = g_clip_sys.task_timers;
+	heap.push_back(w);
+	int i = heap.Size - 1;
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (!task_timer_less(heap[i], heap[parent])) break;
+		ImSwap(heap[i], heap[parent]);
+		i = parent;
+	}
+}
+
+static void task_timer_pop() {
+	ImVector<iam_task_wait>& heap = g_clip_sys.task_timers;
+	heap[0] = heap.back();
+	heap.pop_back();
+	int i = 0;
+	for (;;) {
+		int l = i * 2 + 1, r = l + 1, m = i;
+		if (l < heap.Size && task_timer_less(heap[l], heap[m])) m = l;
+		if (r < heap.Size && task_timer_less(heap[r], heap[m])) m = r;
+		if (m == i) break;
+		ImSwap(heap[i], heap[m]);
+		i = m;
+	}
+}
+
+// Resume what woke up this update: due timers first, then tasks woken by completions and markers
+static void resume_tasks(float dt) {
+	g_clip_sys.task_time += dt;
+	ImVector<iam_task_wait>& heap = g_clip_sys.task_timers;
+	while (heap.Size > 0 && heap[0].wake_time <= g_clip_sys.task_time) {
+		if (heap[0].handle) g_clip_sys.task_ready.push_back(heap[0]);
+		task_timer_pop();
+	}
+	if (g_clip_sys.task_ready.Size == 0) return;
+	// Tasks woken while resuming this batch (or waiting again right away) wait for the next update
+	g_clip_sys.task_resuming.swap(g_clip_sys.task_ready);
+	for (int i = 0; i < g_clip_sys.task_resuming.Size; ++i) {
+		void* handle = g_clip_sys.task_resuming[i].handle;
+		if (handle) std::coroutine_handle<>::from_address(handle).resume();
+	}
+	g_clip_sys.task_resuming.resize(0);
+}
+
+// Find a suspended task's wait and take it out (timers keep a tombstone). Returns its handle or nullptr.
+static void* take_task_wait(unsigned task_id) {
+	ImVector<iam_task_wait>* lists[] = { &g_clip_sys.task_inst_waits, &g_clip_sys.task_marker_waits, &g_clip_sys.task_ready };
+	for (int l = 0; l < IM_ARRAYSIZE(lists); ++l) {
+		ImVector<iam_task_wait>& waits = *lists[l];
+		for (int i = 0; i < waits.Size; ++i) {
+			if (waits[i].task_id != task_id) continue;
+			void* handle = waits[i].handle;
+			waits.erase(waits.Data + i);
+			return handle;
+		}
+	}
+	ImVector<iam_task_wait>* marked[] = { &g_clip_sys.task_timers, &g_clip_sys.task_resuming };
+	for (int l = 0; l < IM_ARRAYSIZE(marked); ++l) {
+		ImVector<iam_task_wait>& waits = *marked[l];
+		for (int i = 0; i < waits.Size; ++i) {
+			if (waits[i].task_id != task_id || !waits[i].handle) continue;
+			void* handle = waits[i].handle;
+			waits[i].handle = nullptr;
+			return handle;
+		}
+	}
+	return nullptr;
+}
+
+static void destroy_tasks() {
+	ImVector<iam_task_wait>* lists[] = { &g_clip_sys.task_timers, &g_clip_sys.task_inst_waits, &g_clip_sys.task_marker_waits,
+		&g_clip_sys.task_ready, &g_clip_sys.task_resuming };
+	ImVector<void*> handles;
+	for (int l = 0; l < IM_ARRAYSIZE(lists); ++l) {
+		for (int i = 0; i < lists[l]->Size; ++i)
+			if ((*lists[l])[i].handle) handles.push_back((*lists[l])[i].handle);
+		lists[l]->clear();
+	}
+	for (int i = 0; i < handles.Size; ++i)
+		std::coroutine_handle<>::from_address(handles[i]).destroy();
+	g_clip_sys.task_live.Clear();
+	for (int c = 0; c < IM_ARRAYSIZE(g_clip_sys.task_pool); ++c) {
+		while (void* block = g_clip_sys.task_pool[c]) {
+			g_clip_sys.task_pool[c] = *(void**)block;
+			IM_FREE(block);
+		}
+	}
+}
+
+} // namespace iam_clip_detail
+
+namespace iam_task_detail {
+
+// Frames are recycled through per-size-class free lists (64-byte steps up to 2 KB); larger ones use IM_ALLOC
+void* frame_alloc(size_t size) {
+	using namespace iam_clip_detail;
+	size_t cls = (size + 63) / 64;
+	if (cls == 0 || cls > (size_t)IM_ARRAYSIZE(g_clip_sys.task_pool)) return IM_ALLOC(size);
+	void* block = g_clip_sys.task_pool[cls - 1];
+	if (!block) return IM_ALLOC(cls * 64);
+	g_clip_sys.task_pool[cls - 1] = *(void**)block;
+	return block;
+}
+
+void frame_free(void* ptr, size_t size) {
+	using namespace iam_clip_detail;
+	size_t cls = (size + 63) / 64;
+	if (cls == 0 || cls > (size_t)IM_ARRAYSIZE(g_clip_sys.task_pool)) { IM_FREE(ptr); return; }
+	*(void**)ptr = g_clip_sys.task_pool[cls - 1];
+	g_clip_sys.task_pool[cls - 1] = ptr;
+}
+
+unsigned task_register() {
+	using namespace iam_clip_detail;
+	if (++g_clip_sys.task_counter == 0) ++g_clip_sys.task_counter;
+	g_clip_sys.task_live.SetInt(g_clip_sys.task_counter, 1);
+	return g_clip_sys.task_counter;
+}
+
+void task_release(unsigned task_id) {
+	iam_clip_detail::g_clip_sys.task_live.SetInt(task_id, 0);
+}
+
+void wait_time(unsigned task_id, void* handle, float seconds) {
+	using namespace iam_clip_detail;
+	iam_task_wait w = { task_id, handle, 0, 0, g_clip_sys.task_time + (seconds > 0.0f ? seconds : 0.0f), g_clip_sys.task_seq++ };
+	task_timer_push(w);
+}
+
+bool instance_active(ImGuiID instance_id) {
+	using namespace iam_clip_detail;
+	iam_instance_data const* inst = find_instance(instance_id);
+	return inst && inst->playing;
+}
+
+void wait_instance(unsigned task_id, void* handle, ImGuiID instance_id) {
+	using namespace iam_clip_detail;
+	iam_task_wait w = { task_id, handle, instance_id, 0, 0.0, 0 };
+	g_clip_sys.task_inst_waits.push_back(w);
+}
+
+void wait_marker(unsigned task_id, void* handle, ImGuiID instance_id, ImGuiID marker_id) {
+	using namespace iam_clip_detail;
+	iam_task_wait w = { task_id, handle, instance_id, marker_id, 0.0, 0 };
+	if (find_instance(instance_id)) g_clip_sys.task_marker_waits.push_back(w);
+	else g_clip_sys.task_ready.push_back(w);  // No such instance: resume next update
+}
+
+} // namespace iam_task_detail
+
+bool iam_task::running() const {
+	return m_id != 0 && iam_clip_detail::g_clip_sys.task_live.GetInt(m_id, 0) != 0;
+}
+
+void iam_task::cancel() {
+	if (!running()) return;
+	void* handle = iam_clip_detail::take_task_wait(m_id);  // nullptr while the task itself is running
+	if (handle) std::coroutine_handle<>::from_address(handle).destroy();
+}
+
+int iam_task_count() {
+	using namespace iam_clip_detail;
+	int count = 0;
+	for (int i = 0; i < g_clip_sys.task_timers.Size; ++i)
+		if (g_clip_sys.task_timers[i].handle) count++;
+	return count + g_clip_sys.task_inst_waits.Size + g_clip_sys.task_marker_waits.Size + g_clip_sys.task_ready.Size;
+}
+
+#endif // IAM_HAS_COROUTINES
+
+// Persistence - binary format
+// Header: "IAMC" (4 bytes) + version (4 bytes) + clip_id (4 bytes)
+// Clip data: duration, delay, loop_count, direction, stagger params
+// Tracks: count + for each: channel, type, num_keys, keys...
+
+static char const IAM_CLIP_MAGIC[4] = { 'I', 'A', 'M', 'C' };
+static int const IAM_CLIP_VERSION = 3;
+
+iam_result iam_clip_save(ImGuiID clip_id, char const* path) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip = find_clip(clip_id);
+	if (!clip) return iam_err_not_found;
+	if (!path) return iam_err_bad_arg;
+	materialize_packed_clip(clip);
+
+	FILE* f = fopen(path, "wb");
+	if (!f) return iam_err_bad_arg;
+
+	// Write header
+	fwrite(IAM_CLIP_MAGIC, 1, 4, f);
+	int version = IAM_CLIP_VERSION;
+	fwrite(&version, sizeof(int), 1, f);
+	fwrite(&clip_id, sizeof(ImGuiID), 1, f);
+
+	// Write clip properties
+	fwrite(&clip->duration, sizeof(float), 1, f);
+	fwrite(&clip->delay, sizeof(float), 1, f);
+	fwrite(&clip->loop_count, sizeof(int), 1, f);
+	fwrite(&clip->direction, sizeof(int), 1, f);
+	fwrite(&clip->stagger_count, sizeof(int), 1, f);
+	fwrite(&clip->stagger_delay, sizeof(float), 1, f);
+	fwrite(&clip->stagger_center_bias, sizeof(float), 1, f);
+
+	// Write tracks
+	int track_count = clip->iam_tracks.Size;
+	fwrite(&track_count, sizeof(int), 1, f);
+
+	for (int t = 0; t < track_count; ++t) {
+		iam_track& trk = clip->iam_tracks[t];
+		fwrite(&trk.channel, sizeof(ImGuiID), 1, f);
+		fwrite(&trk.type, sizeof(int), 1, f);
+
+		int key_count = trk.keys.Size;
+		fwrite(&key_count, sizeof(int), 1, f);
+
+		for (int k = 0; k < key_count; ++k) {
+			keyframe& kf = trk.keys[k];
+			fwrite(&kf.time, sizeof(float), 1, f);
+			fwrite(&kf.ease_type, sizeof(int), 1, f);
+			// Write bools as int to avoid size/alignment issues
+			int has_bezier_i = kf.has_bezier ? 1 : 0;
+			int is_spring_i = kf.is_spring ? 1 : 0;
+			fwrite(&has_bezier_i, sizeof(int), 1, f);
+			fwrite(kf.bezier, sizeof(float), 4, f);
+			fwrite(&is_spring_i, sizeof(int), 1, f);
+			fwrite(&kf.spring.mass, sizeof(float), 1, f);
+			fwrite(&kf.spring.stiffness, sizeof(float), 1, f);
+			fwrite(&kf.spring.damping, sizeof(float), 1, f);
+			fwrite(&kf.spring.initial_velocity, sizeof(float), 1, f);
+			fwrite(kf.value, sizeof(float), 4, f);
+		}
+	}
+
+	// Note: callbacks cannot be serialized
+
+	fclose(f);
+	return iam_ok;
+}
+
+namespace iam_clip_detail {
+
+// Sequential reader over a clip file, or over an in-memory copy of one (streamed loads)
+struct clip_reader {
+	FILE*					f;
+	unsigned char const*	data;
+	size_t					size;
+	size_t					pos;
+
+	size_t read(void* dst, size_t elem_size, size_t count) {
+		if (f) return fread(dst, elem_size, count, f);
+		size_t avail = (size - pos) / elem_size;
+		if (count > avail) count = avail;
+		memcpy(dst, data + pos, elem_size * count);
+		pos += elem_size * count;
+		return count;
+	}
+};
+
+static iam_result load_clip(clip_reader& rd, ImGuiID* out_clip_id) {
+	// Read and verify header
+	char magic[4];
+	if (rd.read(magic, 1, 4) != 4 || memcmp(magic, IAM_CLIP_MAGIC, 4) != 0) {
+		return iam_err_bad_arg;
+	}
+
+	int version;
+	if (rd.read(&version, sizeof(int), 1) != 1 || version != IAM_CLIP_VERSION) {
+		return iam_err_bad_arg;
+	}
+
+	ImGuiID clip_id;
+	if (rd.read(&clip_id, sizeof(ImGuiID), 1) != 1) {
+		return iam_err_bad_arg;
+	}
+
+	// Initialize system if needed
+	if (!g_clip_sys.initialized) iam_clip_init();
+
+	// Create or get clip
+	int idx = g_clip_sys.clip_map.GetInt(clip_id, 0);
+	iam_clip_data* clip;
+	if (idx == 0) {
+		g_clip_sys.clips.push_back(iam_clip_data());
+		clip = &g_clip_sys.clips.back();
+		clip->id = clip_id;
+		g_clip_sys.clip_map.SetInt(clip_id, g_clip_sys.clips.Size);
+	} else {
+		clip = &g_clip_sys.clips[idx - 1];
+		library_forget_clip(clip);  // A reloaded clip is no longer streamed or evicted
+		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+			clip->iam_tracks[t].keys.clear();
+			clip->iam_tracks[t].baked.clear();
+		}
+		clip->iam_tracks.clear();
+		build_channel_index(clip);
+	}
+
+	// Read clip properties
+	rd.read(&clip->duration, sizeof(float), 1);
+	rd.read(&clip->delay, sizeof(float), 1);
+	rd.read(&clip->loop_count, sizeof(int), 1);
+	rd.read(&clip->direction, sizeof(int), 1);
+	rd.read(&clip->stagger_count, sizeof(int), 1);
+	rd.read(&clip->stagger_delay, sizeof(float), 1);
+	rd.read(&clip->stagger_center_bias, sizeof(float), 1);
+
+	// Read tracks
+	int track_count;
+	if (rd.read(&track_count, sizeof(int), 1) != 1) {
+		return iam_err_bad_arg;
+	}
+
+	for (int t = 0; t < track_count; ++t) {
+		// Add track to clip first, then work with it directly to avoid ImVector copy issues
+		clip->iam_tracks.push_back(iam_track());
+		iam_track& trk = clip->iam_tracks.back();
+
+		rd.read(&trk.channel, sizeof(ImGuiID), 1);
+		rd.read(&trk.type, sizeof(int), 1);
+
+		int key_count = 0;
+		rd.read(&key_count, sizeof(int), 1);
+
+		for (int k = 0; k < key_count; ++k) {
+			keyframe kf;
+			rd.read(&kf.time, sizeof(float), 1);
+			rd.read(&kf.ease_type, sizeof(int), 1);
+			// Read bools as int to match save format
+			int has_bezier_i, is_spring_i;
+			rd.read(&has_bezier_i, sizeof(int), 1);
+			rd.read(kf.bezier, sizeof(float), 4);
+			rd.read(&is_spring_i, sizeof(int), 1);
+			rd.read(&kf.spring.mass, sizeof(float), 1);
+			rd.read(&kf.spring.stiffness, sizeof(float), 1);
+			rd.read(&kf.spring.damping, sizeof(float), 1);
+			rd.read(&kf.spring.initial_velocity, sizeof(float), 1);
+			rd.read(kf.value, sizeof(float), 4);
+			kf.has_bezier = (has_bezier_i != 0);
+			kf.is_spring = (is_spring_i != 0);
+			kf.channel = trk.channel;
+			kf.type = trk.type;
+			trk.keys.push_back(kf);
+		}
+	}
+	build_channel_index(clip);
+	prewarm_clip_luts(clip);
+
+	*out_clip_id = clip_id;
+	return iam_ok;
+}
+
+} // namespace iam_clip_detail
+
+iam_result iam_clip_load(char const* path, ImGuiID* out_clip_id) {
+	using namespace iam_clip_detail;
+	if (!path || !out_clip_id) return iam_err_bad_arg;
+
+	FILE* f = fopen(path, "rb");
+	if (!f) return iam_err_not_found;
+	clip_reader rd = { f, nullptr, 0, 0 };
+	iam_result res = load_clip(rd, out_clip_id);
+	fclose(f);
+	return res;
+}
+
+// ----------------------------------------------------
+// Clip packs (see iam_pack_header for the layout)
+// ----------------------------------------------------
+
+namespace iam_clip_detail {
+
+static ImU32 g_pack_serial = 0;
+
+static size_t pack_align16(size_t v) { return (v + 15) & ~(size_t)15; }
+
+static int cmp_clip_id(void const* a, void const* b) {
+	ImGuiID A = *(ImGuiID const*)a;
+	ImGuiID B = *(ImGuiID const*)b;
+	return A < B ? -1 : (A > B ? 1 : 0);
+}
+
+// PACK_KEY_* flags and the 4 parameter floats stored for a key
+static int pack_key_params(keyframe const& kf, float* params) {
+	if (kf.is_spring) {
+		params[0] = kf.spring.mass; params[1] = kf.spring.stiffness;
+		params[2] = kf.spring.damping; params[3] = kf.spring.initial_velocity;
+	} else {
+		memcpy(params, kf.bezier, sizeof(float) * 4);
+	}
+	return (kf.is_spring ? PACK_KEY_SPRING : 0) | (kf.has_bezier ? PACK_KEY_BEZIER : 0);
+}
+
+// Reserve bytes at the end of the build buffer (zero filled) and return their offset
+static size_t pack_push(ImVector<unsigned char>& buf, size_t bytes, bool align16) {
+	size_t offset = align16 ? pack_align16((size_t)buf.Size) : (size_t)buf.Size;
+	size_t old_size = (size_t)buf.Size;
+	buf.resize((int)(offset + bytes));
+	memset(buf.Data + old_size, 0, offset + bytes - old_size);
+	return offset;
+}
+
+// Look up a clip in the open packs; later packs take precedence
+static iam_clip_pack const* find_pack_entry(ImGuiID clip_id, iam_pack_clip_entry const** out_entry) {
+	for (int p = g_clip_sys.packs.Size - 1; p >= 0; --p) {
+		iam_clip_pack const& pack = g_clip_sys.packs[p];
+		int lo = 0, hi = pack.clip_count;
+		while (lo < hi) {
+			int mid = (lo + hi) >> 1;
+			if (pack.index[mid].id < clip_id) lo = mid + 1; else hi = mid;
+		}
+		if (lo < pack.clip_count && pack.index[lo].id == clip_id) {
+			*out_entry = &pack.index[lo];
+			return &pack;
+		}
+	}
+	return nullptr;
+}
+
+// Register a clip from its pack region. Tracks point into the region memory; nothing is copied.
+// region holds the bytes found at region_offset in the pack (blob offsets are pack-relative).
+// The region is checksummed first, a corrupt clip is reported as missing.
+static iam_clip_data* register_packed_region(ImGuiID clip_id, unsigned char const* region, ImU32 region_offset, ImU32 region_size, ImU32 checksum) {
+	if (region_size < sizeof(iam_pack_clip) || ImHashData(region, region_size) != checksum) return nullptr;
+
+	iam_pack_clip const* pc = (iam_pack_clip const*)region;
+	size_t head = sizeof(iam_pack_clip) + (size_t)pc->track_count * sizeof(iam_pack_track) + (size_t)pc->marker_count * sizeof(iam_pack_marker);
+	if (head > region_size) return nullptr;
+	iam_pack_track const* pt = (iam_pack_track const*)(region + sizeof(iam_pack_clip));
+	iam_pack_marker const* pm = (iam_pack_marker const*)(pt + pc->track_count);
+
+	// Every blob must lie inside the checksummed region
+	size_t region_begin = region_offset, region_end = (size_t)region_offset + region_size;
+	for (ImU32 t = 0; t < pc->track_count; ++t) {
+		iam_pack_track const& trk = pt[t];
+		if (trk.type < iam_chan_float || trk.type > iam_chan_color_rel || trk.key_count < 0) return nullptr;
+		size_t k = (size_t)trk.key_count;
+		ImU32 const offsets[5] = { trk.times, trk.values, trk.eases, trk.flags, trk.params };
+		size_t const sizes[5] = { k, k * track_value_size(trk.type), k, k, k * 4 };
+		for (int b = 0; b < 5; ++b)
+			if ((offsets[b] & 3) != 0 || offsets[b] < region_begin || offsets[b] + sizes[b] * 4 > region_end) return nullptr;
+	}
+
+	if (!g_clip_sys.initialized) iam_clip_init();
+	g_clip_sys.clips.push_back(iam_clip_data());
+	iam_clip_data* clip = &g_clip_sys.clips.back();
+	clip->id = clip_id;
+	clip->duration = pc->duration;
+	clip->delay = pc->delay;
+	clip->loop_count = pc->loop_count;
+	clip->direction = pc->direction;
+	clip->stagger_count = pc->stagger_count;
+	clip->stagger_delay = pc->stagger_delay;
+	clip->stagger_center_bias = pc->stagger_center_bias;
+	g_clip_sys.clip_map.SetInt(clip_id, g_clip_sys.clips.Size);
+
+	clip->iam_tracks.reserve((int)pc->track_count);
+	for (ImU32 t = 0; t < pc->track_count; ++t) {
+		clip->iam_tracks.push_back(iam_track());
+		iam_track& trk = clip->iam_tracks.back();
+		iam_pack_track const& src = pt[t];
+		trk.channel = src.channel;
+		trk.type = src.type;
+		trk.color_space = src.color_space;
+		trk.is_relative = src.is_relative != 0;
+		trk.anchor_space = src.anchor_space;
+		trk.anchor_axis = src.anchor_axis;
+		trk.packed_count = src.key_count;
+		trk.packed_times = (float const*)(region + (src.times - region_offset));
+		trk.packed_values = (float const*)(region + (src.values - region_offset));
+		trk.packed_eases = (int const*)(region + (src.eases - region_offset));
+		trk.packed_flags = (int const*)(region + (src.flags - region_offset));
+		trk.packed_params = (float const*)(region + (src.params - region_offset));
+	}
+	for (ImU32 m = 0; m < pc->marker_count; ++m) {
+		iam_marker marker;
+		marker.time = pm[m].time;
+		marker.marker_id = pm[m].marker_id;
+		clip->markers.push_back(marker);
+	}
+	build_channel_index(clip);
+	prewarm_clip_luts(clip);
+	return clip;
+}
+
+// Register a clip from an open pack on first use
+static iam_clip_data* activate_packed_clip(ImGuiID clip_id) {
+	iam_pack_clip_entry const* entry = nullptr;
+	iam_clip_pack const* pack = find_pack_entry(clip_id, &entry);
+	if (!pack) return nullptr;
+	return register_packed_region(clip_id, pack->data + entry->offset, entry->offset, entry->size, entry->checksum);
+}
+
+// Copy packed tracks into regular keyframes (for editing, baking, optimizing or before the pack closes)
+static void materialize_packed_clip(iam_clip_data* clip) {
+	for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+		iam_track& trk = clip->iam_tracks[t];
+		if (trk.packed_count == 0) continue;
+		int n = track_value_size(trk.type);
+		int nv = n > 4 ? 4 : n;
+		trk.keys.resize(0);
+		trk.keys.reserve(trk.packed_count);
+		for (int k = 0; k < trk.packed_count; ++k) {
+			keyframe kf;
+			kf.channel = trk.channel;
+			kf.type = trk.type;
+			kf.color_space = trk.color_space;
+			kf.time = trk.packed_times[k];
+			kf.ease_type = trk.packed_eases[k];
+			float const* params = trk.packed_params + k * 4;
+			float const* values = trk.packed_values + k * n;
+			if (trk.packed_flags[k] & PACK_KEY_SPRING) {
+				kf.is_spring = true;
+				kf.spring.mass = params[0];
+				kf.spring.stiffness = params[1];
+				kf.spring.damping = params[2];
+				kf.spring.initial_velocity = params[3];
+			} else if (trk.packed_flags[k] & PACK_KEY_BEZIER) {
+				kf.has_bezier = true;
+				memcpy(kf.bezier, params, sizeof(float) * 4);
+			}
+			memcpy(kf.value, values, sizeof(float) * nv);
+			if (n > 4) memcpy(kf.value_ext, values + 4, sizeof(float) * (n - 4));
+			trk.keys.push_back(kf);
+		}
+		trk.packed_count = 0;
+		trk.packed_times = trk.packed_values = trk.packed_params = nullptr;
+		trk.packed_eases = trk.packed_flags = nullptr;
+	}
+}
+
+// Validate a pack image and add it to the open list
+static iam_result register_pack(iam_clip_pack& pack, ImGuiID* out_pack_id) {
+	if (!pack.data || pack.size < sizeof(iam_pack_header) || ((size_t)pack.data & 3) != 0) return iam_err_bad_arg;
+	iam_pack_header const* hdr = (iam_pack_header const*)pack.data;
+	if (memcmp(hdr->magic, IAM_PACK_MAGIC, 4) != 0 || hdr->version != IAM_PACK_VERSION) return iam_err_bad_arg;
+	if (hdr->total_size > pack.size) return iam_err_bad_arg;
+	size_t index_bytes = (size_t)hdr->clip_count * sizeof(iam_pack_clip_entry);
+	if (hdr->index_offset < sizeof(iam_pack_header) || (hdr->index_offset & 3) != 0 || hdr->index_offset + index_bytes > hdr->total_size) return iam_err_bad_arg;
+	if (ImHashData(pack.data + hdr->index_offset, index_bytes) != hdr->index_checksum) return iam_err_bad_arg;
+	pack.index = (iam_pack_clip_entry const*)(pack.data + hdr->index_offset);
+	pack.clip_count = (int)hdr->clip_count;
+	for (int i = 0; i < pack.clip_count; ++i)
+		if ((pack.index[i].offset & 3) != 0 || (size_t)pack.index[i].offset + pack.index[i].size > hdr->total_size) return iam_err_bad_arg;
+
+	if (!g_clip_sys.initialized) iam_clip_init();
+	pack.id = ++g_pack_serial;
+	g_clip_sys.packs.push_back(pack);
+	if (out_pack_id) *out_pack_id = pack.id;
+	return iam_ok;
+}
+
+// Release pack memory according to how it was obtained
+static void release_pack_storage(iam_clip_pack& pack) {
+	if (pack.storage == 2) {
+		IM_FREE((void*)pack.data);
+	} else if (pack.storage == 1) {
+#if defined(_WIN32)
+		UnmapViewOfFile(pack.data);
+		CloseHandle((HANDLE)pack.map_handle);
+#elif defined(IAM_PACK_HAS_MMAP)
+		munmap((void*)pack.data, pack.size);
+#endif
+	}
+	pack.data = nullptr;
+}
+
+} // namespace iam_clip_detail
+
+iam_result iam_clip_pack_save(char const* path, ImGuiID const* clip_ids, int count) {
+	using namespace iam_clip_detail;
+	if (!path || (!clip_ids && count > 0) || count < 0) return iam_err_bad_arg;
+
+	ImVector<ImGuiID> ids;
+	ids.resize(count);
+	if (count > 0) memcpy(ids.Data, clip_ids, sizeof(ImGuiID) * count);
+	qsort(ids.Data, (size_t)ids.Size, sizeof(ImGuiID), cmp_clip_id);
+	for (int i = 0; i < ids.Size; ++i) {
+		if (i > 0 && ids[i] == ids[i - 1]) return iam_err_bad_arg;
+		if (!find_clip(ids[i])) return iam_err_not_found;
+	}
+
+	ImVector<unsigned char> buf;
+	pack_push(buf, sizeof(iam_pack_header), false);
+	size_t index_offset = pack_push(buf, sizeof(iam_pack_clip_entry) * ids.Size, true);
+
+	for (int i = 0; i < ids.Size; ++i) {
+		iam_clip_data* clip = find_clip(ids[i]);
+		materialize_packed_clip(clip);
+
+		size_t region = pack_push(buf, sizeof(iam_pack_clip), true);
+		size_t tracks = pack_push(buf, sizeof(iam_pack_track) * clip->iam_tracks.Size, false);
+		size_t markers = pack_push(buf, sizeof(iam_pack_marker) * clip->markers.Size, false);
+
+		iam_pack_clip pc;
+		pc.duration = clip->duration;
+		pc.delay = clip->delay;
+		pc.loop_count = clip->loop_count;
+		pc.direction = clip->direction;
+		pc.stagger_count = clip->stagger_count;
+		pc.stagger_delay = clip->stagger_delay;
+		pc.stagger_center_bias = clip->stagger_center_bias;
+		pc.track_count = (ImU32)clip->iam_tracks.Size;
+		pc.marker_count = (ImU32)clip->markers.Size;
+		memcpy(buf.Data + region, &pc, sizeof(pc));
+
+		for (int m = 0; m < clip->markers.Size; ++m) {
+			iam_pack_marker pm = { clip->markers[m].time, clip->markers[m].marker_id };
+			memcpy(buf.Data + markers + m * sizeof(iam_pack_marker), &pm, sizeof(pm));
+		}
+
+		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+			iam_track const& trk = clip->iam_tracks[t];
+			int k_count = trk.keys.Size;
+			int n = track_value_size(trk.type);
+			int nv = n > 4 ? 4 : n;
+			iam_pack_track pt;
+			pt.channel = trk.channel;
+			pt.type = trk.type;
+			pt.color_space = trk.color_space;
+			pt.is_relative = trk.is_relative ? 1 : 0;
+			pt.anchor_space = trk.anchor_space;
+			pt.anchor_axis = trk.anchor_axis;
+			pt.key_count = k_count;
+			pt.times = (ImU32)pack_push(buf, sizeof(float) * k_count, true);
+			pt.values = (ImU32)pack_push(buf, sizeof(float) * k_count * n, true);
+			pt.eases = (ImU32)pack_push(buf, sizeof(int) * k_count, true);
+			pt.flags = (ImU32)pack_push(buf, sizeof(int) * k_count, true);
+			pt.params = (ImU32)pack_push(buf, sizeof(float) * k_count * 4, true);
+			for (int k = 0; k < k_count; ++k) {
+				keyframe const& kf = trk.keys[k];
+				float params[4];
+				int flags = pack_key_params(kf, params);
+				memcpy(buf.Data + pt.times + k * sizeof(float), &kf.time, sizeof(float));
+				memcpy(buf.Data + pt.values + k * n * sizeof(float), kf.value, sizeof(float) * nv);
+				if (n > 4) memcpy(buf.Data + pt.values + (k * n + 4) * sizeof(float), kf.value_ext, sizeof(float) * (n - 4));
+				memcpy(buf.Data + pt.eases + k * sizeof(int), &kf.ease_type, sizeof(int));
+				memcpy(buf.Data + pt.flags + k * sizeof(int), &flags, sizeof(int));
+				memcpy(buf.Data + pt.params + k * 4 * sizeof(float), params, sizeof(params));
+			}
+			memcpy(buf.Data + tracks + t * sizeof(iam_pack_track), &pt, sizeof(pt));
+		}
+
+		size_t region_end = pack_push(buf, 0, true);
+		iam_pack_clip_entry entry;
+		entry.id = ids[i];
+		entry.offset = (ImU32)region;
+		entry.size = (ImU32)(region_end - region);
+		entry.checksum = ImHashData(buf.Data + region, region_end - region);
+		memcpy(buf.Data + index_offset + i * sizeof(iam_pack_clip_entry), &entry, sizeof(entry));
+	}
+
+	iam_pack_header hdr;
+	memcpy(hdr.magic, IAM_PACK_MAGIC, 4);
+	hdr.version = IAM_PACK_VERSION;
+	hdr.clip_count = (ImU32)ids.Size;
+	hdr.index_offset = (ImU32)index_offset;
+	hdr.total_size = (ImU32)buf.Size;
+	hdr.index_checksum = ImHashData(buf.Data + index_offset, sizeof(iam_pack_clip_entry) * ids.Size);
+	memcpy(buf.Data, &hdr, sizeof(hdr));
+
+	FILE* f = fopen(path, "wb");
+	if (!f) return iam_err_bad_arg;
+	size_t written = fwrite(buf.Data, 1, (size_t)buf.Size, f);
+	fclose(f);
+	return written == (size_t)buf.Size ? iam_ok : iam_err_bad_arg;
+}
+
+iam_result iam_clip_pack_open(void const* data, size_t size, ImGuiID* out_pack_id) {
+	using namespace iam_clip_detail;
+	iam_clip_pack pack = {};
+	pack.data = (unsigned char const*)data;
+	pack.size = size;
+	return register_pack(pack, out_pack_id);
+}
+
+iam_result iam_clip_pack_open_file(char const* path, ImGuiID* out_pack_id) {
+	using namespace iam_clip_detail;
+	if (!path) return iam_err_bad_arg;
+	iam_clip_pack pack = {};
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return iam_err_not_found;
+	LARGE_INTEGER file_size;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping) return iam_err_bad_arg;
+	void const* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) { CloseHandle(mapping); return iam_err_no_mem; }
+	pack.data = (unsigned char const*)view;
+	pack.size = (size_t)file_size.QuadPart;
+	pack.storage = 1;
+	pack.map_handle = mapping;
+#elif defined(IAM_PACK_HAS_MMAP)
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return iam_err_not_found;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return iam_err_bad_arg; }
+	void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED) return iam_err_no_mem;
+	pack.data = (unsigned char const*)view;
+	pack.size = (size_t)st.st_size;
+	pack.storage = 1;
+#else
+	// No mapping API: a single read into an owned buffer
+	FILE* f = fopen(path, "rb");
+	if (!f) return iam_err_not_found;
+	fseek(f, 0, SEEK_END);
+	long file_size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (file_size <= 0) { fclose(f); return iam_err_bad_arg; }
+	void* mem = IM_ALLOC((size_t)file_size);
+	if (!mem) { fclose(f); return iam_err_no_mem; }
+	size_t read = fread(mem, 1, (size_t)file_size, f);
+	fclose(f);
+	pack.data = (unsigned char const*)mem;
+	pack.size = read;
+	pack.storage = 2;
+#endif
+	iam_result res = register_pack(pack, out_pack_id);
+	if (res != iam_ok) release_pack_storage(pack);
+	return res;
+}
+
+void iam_clip_pack_close(ImGuiID pack_id) {
+	using namespace iam_clip_detail;
+	for (int p = 0; p < g_clip_sys.packs.Size; ++p) {
+		iam_clip_pack& pack = g_clip_sys.packs[p];
+		if (pack.id != pack_id) continue;
+		// Clips activated from this pack keep working from their own copy of the keys
+		for (int c = 0; c < g_clip_sys.clips.Size; ++c) {
+			iam_clip_data* clip = &g_clip_sys.clips[c];
+			for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+				unsigned char const* keys = (unsigned char const*)clip->iam_tracks[t].packed_times;
+				if (keys && keys >= pack.data && keys < pack.data + pack.size) {
+					materialize_packed_clip(clip);
+					break;
+				}
+			}
+		}
+		release_pack_storage(pack);
+		g_clip_sys.packs.erase(&pack);
+		return;
+	}
+}
+
+// ----------------------------------------------------
+// Streaming clip library
+// ----------------------------------------------------
+
+namespace iam_clip_detail {
+
+// Worker-safe file read for one request; publishes the result through state
+static void stream_load_task(void* task_data) {
+	iam_clip_stream_request* req = (iam_clip_stream_request*)task_data;
+	int result = 2;
+	FILE* f = fopen(req->path, "rb");
+	if (f) {
+		size_t size = req->size;
+		if (size == 0 && fseek(f, 0, SEEK_END) == 0) {
+			long end = ftell(f);
+			size = end > 0 ? (size_t)end : 0;
+		}
+		if (size > 0 && fseek(f, (long)req->offset, SEEK_SET) == 0) {
+			req->data = (unsigned char*)IM_ALLOC(size);
+			req->data_size = fread(req->data, 1, size, f);
+			if (req->data_size == size) result = 1;
+		}
+		fclose(f);
+	}
+	req->state.store(result, std::memory_order_release);
+}
+
+static void free_stream_request(iam_clip_stream_request* req) {
+	if (req->data) IM_FREE(req->data);
+	IM_FREE(req->path);
+	IM_DELETE(req);
+}
+
+// Approximate heap footprint of a registered clip, used against the library budget
+static size_t clip_memory_bytes(iam_clip_data const* clip) {
+	size_t bytes = sizeof(iam_clip_data) + clip->stream_size;
+	bytes += (size_t)clip->iam_tracks.Capacity * sizeof(iam_track);
+	for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+		bytes += (size_t)clip->iam_tracks[t].keys.Capacity * sizeof(keyframe);
+		bytes += (size_t)clip->iam_tracks[t].baked.Capacity * sizeof(float);
+	}
+	bytes += (size_t)clip->markers.Capacity * sizeof(iam_marker);
+	bytes += (size_t)clip->channel_index.Data.Capacity * sizeof(IMGUI_STORAGE_PAIR);
+	return bytes;
+}
+
+// Free everything a clip owns (ImVector does not run element destructors)
+static void release_clip_data(iam_clip_data* clip) {
+	for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+		clip->iam_tracks[t].keys.clear();
+		clip->iam_tracks[t].baked.clear();
+	}
+	clip->iam_tracks.clear();
+	clip->markers.clear();
+	clip->channel_index.Clear();
+	clip->build_keys.clear();
+	clip->group_stack.clear();
+	if (clip->stream_data) IM_FREE(clip->stream_data);
+	clip->stream_data = nullptr;
+	clip->stream_size = 0;
+}
+
+// Detach a clip from its library entry (it was redefined by hand)
+static void library_forget_clip(iam_clip_data* clip) {
+	iam_clip_library& lib = g_clip_sys.library;
+	if (clip->library_entry >= 0) {
+		iam_library_entry& entry = lib.entries[clip->library_entry];
+		lib.resident_bytes -= entry.bytes;
+		entry.bytes = 0;
+		entry.state = library_unloaded;
+		clip->library_entry = -1;
+	}
+	if (clip->stream_data) {
+		materialize_packed_clip(clip);
+		IM_FREE(clip->stream_data);
+		clip->stream_data = nullptr;
+		clip->stream_size = 0;
+	}
+}
+
+// Turn a finished request into a registered clip. Pack regions are used in place; single-clip files are parsed.
+static void library_apply(int entry_index) {
+	iam_clip_library& lib = g_clip_sys.library;
+	iam_library_entry& entry = lib.entries[entry_index];
+	iam_clip_stream_request* req = entry.request;
+	entry.request = nullptr;
+	entry.state = library_unloaded;
+	lib.loading--;
+
+	iam_clip_data* clip = nullptr;
+	if (req->state.load(std::memory_order_acquire) == 1 && !find_clip(entry.clip_id)) {
+		if (lib.sources[entry.source].is_pack) {
+			clip = register_packed_region(entry.clip_id, req->data, entry.offset, entry.size, entry.checksum);
+			if (clip) {
+				clip->stream_data = req->data;  // Tracks point into this buffer now
+				clip->stream_size = req->data_size;
+				req->data = nullptr;
+			}
+		} else {
+			clip_reader rd = { nullptr, req->data, req->data_size, 0 };
+			ImGuiID loaded_id = 0;
+			if (load_clip(rd, &loaded_id) == iam_ok) clip = find_clip(loaded_id);
+			if (clip && loaded_id != entry.clip_id) clip = nullptr;  // File holds another clip: leave it registered, unmanaged
+		}
+	}
+	free_stream_request(req);
+	if (!clip) return;
+
+	clip->library_entry = entry_index;
+	entry.state = library_resident;
+	entry.bytes = clip_memory_bytes(clip);
+	lib.resident_bytes += entry.bytes;
+}
+
+// Start loading an entry: inline without a submit hook, otherwise on the user's worker
+static void library_load(int entry_index) {
+	iam_clip_library& lib = g_clip_sys.library;
+	iam_library_entry& entry = lib.entries[entry_index];
+	char const* path = lib.path_pool.Data + lib.sources[entry.source].path_offset;
+	size_t len = strlen(path) + 1;
+
+	iam_clip_stream_request* req = IM_NEW(iam_clip_stream_request)();
+	req->path = (char*)IM_ALLOC(len);
+	memcpy(req->path, path, len);
+	req->offset = entry.offset;
+	req->size = entry.size;
+	req->data = nullptr;
+	req->data_size = 0;
+	req->state.store(0, std::memory_order_relaxed);
+
+	entry.request = req;
+	entry.state = library_loading;
+	lib.loading++;
+	if (lib.submit) {
+		lib.submit(stream_load_task, req, lib.submit_user);
+	} else {
+		stream_load_task(req);
+		library_apply(entry_index);
+	}
+}
+
+// Resolve a clip for iam_play: bump its LRU stamp and load it if it is a non-resident library clip.
+// Returns nullptr with *out_pending set while an asynchronous load is in flight.
+static iam_clip_data* library_acquire(ImGuiID clip_id, iam_clip_data* clip, bool* out_pending) {
+	iam_clip_library& lib = g_clip_sys.library;
+	*out_pending = false;
+	int idx = lib.entry_map.GetInt(clip_id, 0) - 1;
+	if (idx < 0) return clip;
+	lib.entries[idx].last_used = ++lib.use_serial;
+	if (clip) return clip;
+	if (lib.entries[idx].state == library_unloaded) library_load(idx);
+	if (lib.entries[idx].state == library_loading) {
+		*out_pending = true;
+		return nullptr;
+	}
+	return find_clip(clip_id);
+}
+
+// Evict least recently played resident clips until under budget. Clips referenced by any instance stay.
+static void library_enforce_budget() {
+	iam_clip_library& lib = g_clip_sys.library;
+	if (lib.budget == 0 || lib.resident_bytes <= lib.budget) return;
+
+	ImGuiStorage in_use;
+	for (int i = 0; i < g_clip_sys.instances.slot_count; ++i) {
+		iam_instance_data const* inst = g_clip_sys.instances.at(i);
+		if (inst->inst_id != 0) in_use.SetInt(inst->clip_id, 1);
+	}
+	while (lib.resident_bytes > lib.budget) {
+		int victim = -1;
+		for (int e = 0; e < lib.entries.Size; ++e) {
+			iam_library_entry const& entry = lib.entries[e];
+			if (entry.state != library_resident || in_use.GetInt(entry.clip_id, 0)) continue;
+			if (victim < 0 || entry.last_used < lib.entries[victim].last_used) victim = e;
+		}
+		if (victim < 0) break;
+
+		iam_library_entry& entry = lib.entries[victim];
+		int clip_index = g_clip_sys.clip_map.GetInt(entry.clip_id, 0) - 1;
+		iam_clip_data* clip = &g_clip_sys.clips[clip_index];
+		release_clip_data(clip);
+		int last = g_clip_sys.clips.Size - 1;
+		if (clip_index != last) {
+			g_clip_sys.clips[clip_index] = g_clip_sys.clips[last];
+			g_clip_sys.clip_map.SetInt(g_clip_sys.clips[clip_index].id, clip_index + 1);
+		}
+		g_clip_sys.clips.pop_back();
+		g_clip_sys.clip_map.SetInt(entry.clip_id, 0);
+		lib.resident_bytes -= entry.bytes;
+		entry.bytes = 0;
+		entry.state = library_unloaded;
+	}
 }
 
-bool iam_get_blended_int(ImGuiID instance_id, ImGuiID channel, int* out) {
-	using namespace iam_clip_detail;
-	iam_instance_data* inst = find_instance(instance_id);
-	if (!inst || !inst->has_blended || !out) return false;
-	for (int i = 0; i < inst->blended_int.Data.Size; ++i) {
-		if (inst->blended_int.Data[i].key == channel) {
-			*out = inst->blended_int.Data[i].val_i;
-			return true;
+// Apply finished loads, start instances that were waiting on them, then trim to budget
+static void library_poll() {
+	iam_clip_library& lib = g_clip_sys.library;
+	if (lib.loading > 0) {
+		for (int e = 0; e < lib.entries.Size; ++e) {
+			iam_clip_stream_request* req = lib.entries[e].request;
+			if (req && req->state.load(std::memory_order_acquire) != 0) library_apply(e);
 		}
 	}
-	return false;
+	for (int i = 0; i < g_clip_sys.instances.slot_count; ++i) {
+		iam_instance_data* inst = g_clip_sys.instances.at(i);
+		if (!inst->pending_load) continue;
+		inst->last_seen_frame = g_clip_sys.frame_counter;
+		if (iam_clip_data* clip = find_clip(inst->clip_id)) {
+			start_instance(inst, clip);
+			if (inst->lane_count > 0) start_lanes(inst, clip);  // Requested by iam_play_instanced
+		} else {
+			int idx = lib.entry_map.GetInt(inst->clip_id, 0) - 1;
+			if (idx < 0 || lib.entries[idx].state != library_loading) {
+				inst->pending_load = false;  // Load failed
+				inst->playing = false;
+			}
+		}
+	}
+	library_enforce_budget();
 }
 
-// Persistence - binary format
-// Header: "IAMC" (4 bytes) + version (4 bytes) + clip_id (4 bytes)
-// Clip data: duration, delay, loop_count, direction, stagger params
-// Tracks: count + for each: channel, type, num_keys, keys...
+static int library_add_source(char const* path, bool is_pack) {
+	iam_clip_library& lib = g_clip_sys.library;
+	iam_library_source src;
+	src.path_offset = lib.path_pool.Size;
+	src.is_pack = is_pack;
+	int len = (int)strlen(path) + 1;
+	lib.path_pool.resize(lib.path_pool.Size + len);
+	memcpy(lib.path_pool.Data + src.path_offset, path, (size_t)len);
+	lib.sources.push_back(src);
+	return lib.sources.Size - 1;
+}
 
-static char const IAM_CLIP_MAGIC[4] = { 'I', 'A', 'M', 'C' };
-static int const IAM_CLIP_VERSION = 3;
+static void library_add_entry(ImGuiID clip_id, int source, ImU32 offset, ImU32 size, ImU32 checksum) {
+	iam_clip_library& lib = g_clip_sys.library;
+	int idx = lib.entry_map.GetInt(clip_id, 0) - 1;
+	if (idx < 0) {
+		lib.entries.push_back(iam_library_entry());
+		idx = lib.entries.Size - 1;
+		memset(&lib.entries[idx], 0, sizeof(iam_library_entry));
+		lib.entries[idx].clip_id = clip_id;
+		lib.entry_map.SetInt(clip_id, idx + 1);
+	} else if (lib.entries[idx].state != library_unloaded) {
+		return;  // Keep the copy that is loaded or loading
+	}
+	iam_library_entry& entry = lib.entries[idx];
+	entry.source = source;
+	entry.offset = offset;
+	entry.size = size;
+	entry.checksum = checksum;
+}
 
-iam_result iam_clip_save(ImGuiID clip_id, char const* path) {
+} // namespace iam_clip_detail
+
+iam_result iam_clip_library_add_pack(char const* path) {
 	using namespace iam_clip_detail;
-	iam_clip_data* clip = find_clip(clip_id);
-	if (!clip) return iam_err_not_found;
 	if (!path) return iam_err_bad_arg;
+	if (!g_clip_sys.initialized) iam_clip_init();
 
-	FILE* f = fopen(path, "wb");
-	if (!f) return iam_err_bad_arg;
-
-	// Write header
-	fwrite(IAM_CLIP_MAGIC, 1, 4, f);
-	int version = IAM_CLIP_VERSION;
-	fwrite(&version, sizeof(int), 1, f);
-	fwrite(&clip_id, sizeof(ImGuiID), 1, f);
+	// Only the header and index are read now
+	FILE* f = fopen(path, "rb");
+	if (!f) return iam_err_not_found;
+	iam_pack_header hdr;
+	iam_result res = iam_err_bad_arg;
+	ImVector<iam_pack_clip_entry> index;
+	if (fread(&hdr, sizeof(hdr), 1, f) == 1 && memcmp(hdr.magic, IAM_PACK_MAGIC, 4) == 0 && hdr.version == IAM_PACK_VERSION) {
+		index.resize((int)hdr.clip_count);
+		size_t bytes = sizeof(iam_pack_clip_entry) * hdr.clip_count;
+		if (fseek(f, (long)hdr.index_offset, SEEK_SET) == 0 && fread(index.Data, 1, bytes, f) == bytes && ImHashData(index.Data, bytes) == hdr.index_checksum)
+			res = iam_ok;
+	}
+	fclose(f);
+	if (res != iam_ok) return res;
 
-	// Write clip properties
-	fwrite(&clip->duration, sizeof(float), 1, f);
-	fwrite(&clip->delay, sizeof(float), 1, f);
-	fwrite(&clip->loop_count, sizeof(int), 1, f);
-	fwrite(&clip->direction, sizeof(int), 1, f);
-	fwrite(&clip->stagger_count, sizeof(int), 1, f);
-	fwrite(&clip->stagger_delay, sizeof(float), 1, f);
-	fwrite(&clip->stagger_center_bias, sizeof(float), 1, f);
+	int source = library_add_source(path, true);
+	for (int i = 0; i < index.Size; ++i)
+		library_add_entry(index[i].id, source, index[i].offset, index[i].size, index[i].checksum);
+	return iam_ok;
+}
 
-	// Write tracks
-	int track_count = clip->iam_tracks.Size;
-	fwrite(&track_count, sizeof(int), 1, f);
+iam_result iam_clip_library_add_file(ImGuiID clip_id, char const* path) {
+	using namespace iam_clip_detail;
+	if (!path) return iam_err_bad_arg;
+	if (!g_clip_sys.initialized) iam_clip_init();
+	library_add_entry(clip_id, library_add_source(path, false), 0, 0, 0);
+	return iam_ok;
+}
 
-	for (int t = 0; t < track_count; ++t) {
-		iam_track& trk = clip->iam_tracks[t];
-		fwrite(&trk.channel, sizeof(ImGuiID), 1, f);
-		fwrite(&trk.type, sizeof(int), 1, f);
+namespace iam_clip_detail {
 
-		int key_count = trk.keys.Size;
-		fwrite(&key_count, sizeof(int), 1, f);
+// Register one directory file if it carries a clip header
+static bool library_add_dir_file(char const* dir, char const* name) {
+	size_t len = strlen(name);
+	if (len < 6 || strcmp(name + len - 6, ".ianim") != 0) return false;
+	char path[1024];
+	if ((size_t)snprintf(path, sizeof(path), "%s/%s", dir, name) >= sizeof(path)) return false;
 
-		for (int k = 0; k < key_count; ++k) {
-			keyframe& kf = trk.keys[k];
-			fwrite(&kf.time, sizeof(float), 1, f);
-			fwrite(&kf.ease_type, sizeof(int), 1, f);
-			// Write bools as int to avoid size/alignment issues
-			int has_bezier_i = kf.has_bezier ? 1 : 0;
-			int is_spring_i = kf.is_spring ? 1 : 0;
-			fwrite(&has_bezier_i, sizeof(int), 1, f);
-			fwrite(kf.bezier, sizeof(float), 4, f);
-			fwrite(&is_spring_i, sizeof(int), 1, f);
-			fwrite(&kf.spring.mass, sizeof(float), 1, f);
-			fwrite(&kf.spring.stiffness, sizeof(float), 1, f);
-			fwrite(&kf.spring.damping, sizeof(float), 1, f);
-			fwrite(&kf.spring.initial_velocity, sizeof(float), 1, f);
-			fwrite(kf.value, sizeof(float), 4, f);
-		}
-	}
+	FILE* f = fopen(path, "rb");
+	if (!f) return false;
+	char magic[4];
+	int version = 0;
+	ImGuiID clip_id = 0;
+	bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, IAM_CLIP_MAGIC, 4) == 0
+		&& fread(&version, sizeof(int), 1, f) == 1 && fread(&clip_id, sizeof(ImGuiID), 1, f) == 1;
+	fclose(f);
+	if (ok) library_add_entry(clip_id, library_add_source(path, false), 0, 0, 0);
+	return ok;
+}
 
-	// Note: callbacks cannot be serialized
+} // namespace iam_clip_detail
 
-	fclose(f);
+iam_result iam_clip_library_add_dir(char const* dir, int* out_count) {
+	using namespace iam_clip_detail;
+	if (!dir) return iam_err_bad_arg;
+	if (!g_clip_sys.initialized) iam_clip_init();
+	int count = 0;
+#ifdef _WIN32
+	char pattern[1024];
+	snprintf(pattern, sizeof(pattern), "%s/*.ianim", dir);
+	WIN32_FIND_DATAA fd;
+	HANDLE h = FindFirstFileA(pattern, &fd);
+	if (h == INVALID_HANDLE_VALUE) return iam_err_not_found;
+	do {
+		if (library_add_dir_file(dir, fd.cFileName)) count++;
+	} while (FindNextFileA(h, &fd));
+	FindClose(h);
+#elif defined(IAM_PACK_HAS_MMAP)
+	DIR* d = opendir(dir);
+	if (!d) return iam_err_not_found;
+	while (struct dirent* ent = readdir(d))
+		if (library_add_dir_file(dir, ent->d_name)) count++;
+	closedir(d);
+#else
+	return iam_err_not_found;  // No directory listing on this platform; use iam_clip_library_add_file
+#endif
+	if (out_count) *out_count = count;
 	return iam_ok;
 }
 
-iam_result iam_clip_load(char const* path, ImGuiID* out_clip_id) {
+void iam_clip_library_set_budget(size_t max_bytes) {
 	using namespace iam_clip_detail;
-	if (!path || !out_clip_id) return iam_err_bad_arg;
-
-	FILE* f = fopen(path, "rb");
-	if (!f) return iam_err_not_found;
+	g_clip_sys.library.budget = max_bytes;
+	library_enforce_budget();
+}
 
-	// Read and verify header
-	char magic[4];
-	if (fread(magic, 1, 4, f) != 4 || memcmp(magic, IAM_CLIP_MAGIC, 4) != 0) {
-		fclose(f);
-		return iam_err_bad_arg;
-	}
+void iam_clip_library_set_async(iam_clip_submit_fn fn, void* user) {
+	using namespace iam_clip_detail;
+	g_clip_sys.library.submit = fn;
+	g_clip_sys.library.submit_user = user;
+}
 
-	int version;
-	if (fread(&version, sizeof(int), 1, f) != 1 || version != IAM_CLIP_VERSION) {
-		fclose(f);
-		return iam_err_bad_arg;
-	}
+void iam_clip_library_get_stats(size_t* out_resident_bytes, int* out_resident, int* out_loading) {
+	using namespace iam_clip_detail;
+	iam_clip_library const& lib = g_clip_sys.library;
+	int resident = 0;
+	for (int e = 0; e < lib.entries.Size; ++e)
+		if (lib.entries[e].state == library_resident) resident++;
+	if (out_resident_bytes) *out_resident_bytes = lib.resident_bytes;
+	if (out_resident) *out_resident = resident;
+	if (out_loading) *out_loading = lib.loading;
+}
 
-	ImGuiID clip_id;
-	if (fread(&clip_id, sizeof(ImGuiID), 1, f) != 1) {
-		fclose(f);
-		return iam_err_bad_arg;
-	}
+// ----------------------------------------------------
+// Static clips (compiled-in tables) and C++ export
+// ----------------------------------------------------
 
-	// Initialize system if needed
+iam_result iam_clip_register_static(iam_static_clip const* clips, int count) {
+	using namespace iam_clip_detail;
+	if ((!clips && count > 0) || count < 0) return iam_err_bad_arg;
 	if (!g_clip_sys.initialized) iam_clip_init();
 
-	// Create or get clip
-	int idx = g_clip_sys.clip_map.GetInt(clip_id, 0);
-	iam_clip_data* clip;
-	if (idx == 0) {
+	iam_result res = iam_ok;
+	for (int i = 0; i < count; ++i) {
+		iam_static_clip const& src = clips[i];
+		bool valid = g_clip_sys.clip_map.GetInt(src.id, 0) == 0 && src.track_count >= 0 && src.marker_count >= 0
+			&& (src.tracks || src.track_count == 0) && (src.markers || src.marker_count == 0);
+		for (int t = 0; valid && t < src.track_count; ++t) {
+			iam_static_track const& st = src.tracks[t];
+			valid = st.type >= iam_chan_float && st.type <= iam_chan_color_rel && st.key_count >= 0
+				&& (st.key_count == 0 || (st.times && st.values && st.eases && st.flags && st.params));
+		}
+		if (!valid) { res = iam_err_bad_arg; continue; }
+
+		// Same in-place representation as packed clips; the tables are already in evaluation order
 		g_clip_sys.clips.push_back(iam_clip_data());
-		clip = &g_clip_sys.clips.back();
-		clip->id = clip_id;
-		g_clip_sys.clip_map.SetInt(clip_id, g_clip_sys.clips.Size);
-	} else {
-		clip = &g_clip_sys.clips[idx - 1];
-		clip->iam_tracks.clear();
-	}
+		iam_clip_data* clip = &g_clip_sys.clips.back();
+		clip->id = src.id;
+		clip->duration = src.duration;
+		clip->delay = src.delay;
+		clip->loop_count = src.loop_count;
+		clip->direction = src.direction;
+		clip->stagger_count = src.stagger_count;
+		clip->stagger_delay = src.stagger_delay;
+		clip->stagger_center_bias = src.stagger_center_bias;
+		g_clip_sys.clip_map.SetInt(src.id, g_clip_sys.clips.Size);
+
+		clip->iam_tracks.reserve(src.track_count);
+		for (int t = 0; t < src.track_count; ++t) {
+			clip->iam_tracks.push_back(iam_track());
+			iam_track& trk = clip->iam_tracks.back();
+			iam_static_track const& st = src.tracks[t];
+			trk.channel = st.channel;
+			trk.type = st.type;
+			trk.color_space = st.color_space;
+			trk.is_relative = st.is_relative != 0;
+			trk.anchor_space = st.anchor_space;
+			trk.anchor_axis = st.anchor_axis;
+			trk.packed_count = st.key_count;
+			trk.packed_times = st.times;
+			trk.packed_values = st.values;
+			trk.packed_eases = st.eases;
+			trk.packed_flags = st.flags;
+			trk.packed_params = st.params;
+		}
+		clip->markers.reserve(src.marker_count);
+		for (int m = 0; m < src.marker_count; ++m) {
+			iam_marker marker;
+			marker.time = src.markers[m].time;
+			marker.marker_id = src.markers[m].marker_id;
+			clip->markers.push_back(marker);
+		}
+		build_channel_index(clip);
+		prewarm_clip_luts(clip);
+	}
+	return res;
+}
 
-	// Read clip properties
-	fread(&clip->duration, sizeof(float), 1, f);
-	fread(&clip->delay, sizeof(float), 1, f);
-	fread(&clip->loop_count, sizeof(int), 1, f);
-	fread(&clip->direction, sizeof(int), 1, f);
-	fread(&clip->stagger_count, sizeof(int), 1, f);
-	fread(&clip->stagger_delay, sizeof(float), 1, f);
-	fread(&clip->stagger_center_bias, sizeof(float), 1, f);
+namespace iam_clip_detail {
 
-	// Read tracks
-	int track_count;
-	if (fread(&track_count, sizeof(int), 1, f) != 1) {
-		fclose(f);
-		return iam_err_bad_arg;
+// Shortest literal that reads back as the same float
+static void export_float(FILE* f, float v) {
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.9g", v);
+	if (!strpbrk(buf, ".eEn")) strcat(buf, ".0");
+	fprintf(f, "%sf", buf);
+}
+
+static void export_float_array(FILE* f, char const* symbol, int c, int t, char const* name, float const* data, int n) {
+	fprintf(f, "static constexpr float %s_%d_%d_%s[] = {", symbol, c, t, name);
+	for (int i = 0; i < n; ++i) {
+		fputs(i % 8 == 0 ? "\n\t" : " ", f);
+		export_float(f, data[i]);
+		fputc(',', f);
 	}
+	fputs("\n};\n", f);
+}
 
-	for (int t = 0; t < track_count; ++t) {
-		// Add track to clip first, then work with it directly to avoid ImVector copy issues
-		clip->iam_tracks.push_back(iam_track());
-		iam_track& trk = clip->iam_tracks.back();
+static void export_int_array(FILE* f, char const* symbol, int c, int t, char const* name, int const* data, int n) {
+	fprintf(f, "static constexpr int %s_%d_%d_%s[] = {", symbol, c, t, name);
+	for (int i = 0; i < n; ++i)
+		fprintf(f, "%s%d,", i % 16 == 0 ? "\n\t" : " ", data[i]);
+	fputs("\n};\n", f);
+}
 
-		fread(&trk.channel, sizeof(ImGuiID), 1, f);
-		fread(&trk.type, sizeof(int), 1, f);
+} // namespace iam_clip_detail
 
-		int key_count;
-		fread(&key_count, sizeof(int), 1, f);
+iam_result iam_clip_export_cpp(char const* path, char const* symbol, ImGuiID const* clip_ids, int count) {
+	using namespace iam_clip_detail;
+	if (!path || !symbol || !symbol[0] || (!clip_ids && count > 0) || count < 0) return iam_err_bad_arg;
+	for (int i = 0; i < count; ++i)
+		if (!find_clip(clip_ids[i])) return iam_err_not_found;
 
-		for (int k = 0; k < key_count; ++k) {
-			keyframe kf;
-			fread(&kf.time, sizeof(float), 1, f);
-			fread(&kf.ease_type, sizeof(int), 1, f);
-			// Read bools as int to match save format
-			int has_bezier_i, is_spring_i;
-			fread(&has_bezier_i, sizeof(int), 1, f);
-			fread(kf.bezier, sizeof(float), 4, f);
-			fread(&is_spring_i, sizeof(int), 1, f);
-			fread(&kf.spring.mass, sizeof(float), 1, f);
-			fread(&kf.spring.stiffness, sizeof(float), 1, f);
-			fread(&kf.spring.damping, sizeof(float), 1, f);
-			fread(&kf.spring.initial_velocity, sizeof(float), 1, f);
-			fread(kf.value, sizeof(float), 4, f);
-			kf.has_bezier = (has_bezier_i != 0);
-			kf.is_spring = (is_spring_i != 0);
-			kf.channel = trk.channel;
-			kf.type = trk.type;
-			trk.keys.push_back(kf);
-		}
-	}
+	FILE* f = fopen(path, "w");
+	if (!f) return iam_err_bad_arg;
+	fprintf(f, "// Generated by iam_clip_export_cpp - do not edit.\n// Register with: iam_clip_register_static(%s, %s_count);\n#pragma once\n#include \"im_anim.h\"\n\n", symbol, symbol);
 
+	ImVector<float> times, values, params;
+	ImVector<int> eases, flags;
+	for (int c = 0; c < count; ++c) {
+		iam_clip_data* clip = find_clip(clip_ids[c]);
+		materialize_packed_clip(clip);
+		for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+			iam_track const& trk = clip->iam_tracks[t];
+			int k_count = trk.keys.Size;
+			if (k_count == 0) continue;
+			int n = track_value_size(trk.type);
+			int nv = n > 4 ? 4 : n;
+			values.resize(k_count * n);
+			params.resize(k_count * 4);
+			eases.resize(k_count);
+			flags.resize(k_count);
+			times.resize(k_count);
+			for (int k = 0; k < k_count; ++k) {
+				keyframe const& kf = trk.keys[k];
+				times[k] = kf.time;
+				memcpy(values.Data + k * n, kf.value, sizeof(float) * nv);
+				if (n > 4) memcpy(values.Data + k * n + 4, kf.value_ext, sizeof(float) * (n - 4));
+				eases[k] = kf.ease_type;
+				flags[k] = pack_key_params(kf, params.Data + k * 4);
+			}
+			export_float_array(f, symbol, c, t, "times", times.Data, k_count);
+			export_float_array(f, symbol, c, t, "values", values.Data, k_count * n);
+			export_int_array(f, symbol, c, t, "eases", eases.Data, k_count);
+			export_int_array(f, symbol, c, t, "flags", flags.Data, k_count);
+			export_float_array(f, symbol, c, t, "params", params.Data, k_count * 4);
+		}
+
+		if (clip->iam_tracks.Size > 0) {
+			fprintf(f, "static constexpr iam_static_track %s_%d_tracks[] = {\n", symbol, c);
+			for (int t = 0; t < clip->iam_tracks.Size; ++t) {
+				iam_track const& trk = clip->iam_tracks[t];
+				fprintf(f, "\t{ 0x%08Xu, %d, %d, %d, %d, %d, %d, ", trk.channel, trk.type, trk.color_space, trk.is_relative ? 1 : 0, trk.anchor_space, trk.anchor_axis, trk.keys.Size);
+				if (trk.keys.Size > 0)
+					fprintf(f, "%s_%d_%d_times, %s_%d_%d_values, %s_%d_%d_eases, %s_%d_%d_flags, %s_%d_%d_params },\n",
+						symbol, c, t, symbol, c, t, symbol, c, t, symbol, c, t, symbol, c, t);
+				else
+					fputs("nullptr, nullptr, nullptr, nullptr, nullptr },\n", f);
+			}
+			fputs("};\n", f);
+		}
+		if (clip->markers.Size > 0) {
+			fprintf(f, "static constexpr iam_static_marker %s_%d_markers[] = {\n", symbol, c);
+			for (int m = 0; m < clip->markers.Size; ++m) {
+				fputs("\t{ ", f);
+				export_float(f, clip->markers[m].time);
+				fprintf(f, ", 0x%08Xu },\n", clip->markers[m].marker_id);
+			}
+			fputs("};\n", f);
+		}
+		fputc('\n', f);
+	}
+
+	fprintf(f, "static constexpr iam_static_clip %s[] = {\n", symbol);
+	for (int c = 0; c < count; ++c) {
+		iam_clip_data const* clip = find_clip(clip_ids[c]);
+		fprintf(f, "\t{ 0x%08Xu, ", clip->id);
+		export_float(f, clip->duration); fputs(", ", f);
+		export_float(f, clip->delay);
+		fprintf(f, ", %d, %d, %d, ", clip->loop_count, clip->direction, clip->stagger_count);
+		export_float(f, clip->stagger_delay); fputs(", ", f);
+		export_float(f, clip->stagger_center_bias); fputs(", ", f);
+		if (clip->iam_tracks.Size > 0) fprintf(f, "%s_%d_tracks, %d, ", symbol, c, clip->iam_tracks.Size);
+		else fputs("nullptr, 0, ", f);
+		if (clip->markers.Size > 0) fprintf(f, "%s_%d_markers, %d },\n", symbol, c, clip->markers.Size);
+		else fputs("nullptr, 0 },\n", f);
+	}
+	fprintf(f, "};\nstatic constexpr int %s_count = %d;\n", symbol, count);
+	bool ok = ferror(f) == 0;
 	fclose(f);
-	*out_clip_id = clip_id;
-	return iam_ok;
+	return ok ? iam_ok : iam_err_bad_arg;
 }
 
 // ----------------------------------------------------
@@ -3865,15 +8187,12 @@ struct osc_state {
 	osc_state() : time(0), last_frame(0) {}
 };
 
-static ImGuiStorage g_osc_map;
+// Pooled like tween channels (plain data, so snapshots restore it with one reserve). Pointers are valid until
+// the next get_osc.
+static ImPool<osc_state> g_osc_pool;
 
 static osc_state* get_osc(ImGuiID id) {
-	osc_state* s = (osc_state*)g_osc_map.GetVoidPtr(id);
-	if (!s) {
-		s = IM_NEW(osc_state)();
-		g_osc_map.SetVoidPtr(id, s);
-	}
-	return s;
+	return g_osc_pool.GetOrAddByKey(id);
 }
 
 static float eval_wave(int wave_type, float t) {
@@ -3897,9 +8216,9 @@ static float eval_wave(int wave_type, float t) {
 
 float iam_oscillate(ImGuiID id, float amplitude, float frequency, int wave_type, float phase, float dt) {
 	using namespace iam_osc_detail;
-	dt *= iam_detail::g_time_scale;
+	dt *= iam_detail::current_time_scale();
 	osc_state* s = get_osc(id);
-	if (s->last_frame != iam_detail::g_frame) {
+	if (s->last_frame != iam_detail::g_frame && !iam_detail::domain_paused(iam_detail::g_domain)) {
 		s->time += dt;
 		s->last_frame = iam_detail::g_frame;
 	}
@@ -3910,9 +8229,9 @@ float iam_oscillate(ImGuiID id, float amplitude, float frequency, int wave_type,
 
 ImVec2 iam_oscillate_vec2(ImGuiID id, ImVec2 amplitude, ImVec2 frequency, int wave_type, ImVec2 phase, float dt) {
 	using namespace iam_osc_detail;
-	dt *= iam_detail::g_time_scale;
+	dt *= iam_detail::current_time_scale();
 	osc_state* s = get_osc(id);
-	if (s->last_frame != iam_detail::g_frame) {
+	if (s->last_frame != iam_detail::g_frame && !iam_detail::domain_paused(iam_detail::g_domain)) {
 		s->time += dt;
 		s->last_frame = iam_detail::g_frame;
 	}
@@ -3923,9 +8242,9 @@ ImVec2 iam_oscillate_vec2(ImGuiID id, ImVec2 amplitude, ImVec2 frequency, int wa
 
 ImVec4 iam_oscillate_vec4(ImGuiID id, ImVec4 amplitude, ImVec4 frequency, int wave_type, ImVec4 phase, float dt) {
 	using namespace iam_osc_detail;
-	dt *= iam_detail::g_time_scale;
+	dt *= iam_detail::current_time_scale();
 	osc_state* s = get_osc(id);
-	if (s->last_frame != iam_detail::g_frame) {
+	if (s->last_frame != iam_detail::g_frame && !iam_detail::domain_paused(iam_detail::g_domain)) {
 		s->time += dt;
 		s->last_frame = iam_detail::g_frame;
 	}
@@ -3943,9 +8262,9 @@ ImVec4 iam_oscillate_vec4(ImGuiID id, ImVec4 amplitude, ImVec4 frequency, int wa
 
 ImVec4 iam_oscillate_color(ImGuiID id, ImVec4 base_color, ImVec4 amplitude, float frequency, int wave_type, float phase, int color_space, float dt) {
 	using namespace iam_osc_detail;
-	dt *= iam_detail::g_time_scale;
+	dt *= iam_detail::current_time_scale();
 	osc_state* s = get_osc(id);
-	if (s->last_frame != iam_detail::g_frame) {
+	if (s->last_frame != iam_detail::g_frame && !iam_detail::domain_paused(iam_detail::g_domain)) {
 		s->time += dt;
 		s->last_frame = iam_detail::g_frame;
 	}
@@ -4011,15 +8330,10 @@ struct shake_state {
 	}
 };
 
-static ImGuiStorage g_shake_map;
+static ImPool<shake_state> g_shake_pool;  // Pointers are valid until the next get_shake
 
 static shake_state* get_shake(ImGuiID id) {
-	shake_state* s = (shake_state*)g_shake_map.GetVoidPtr(id);
-	if (!s) {
-		s = IM_NEW(shake_state)();
-		g_shake_map.SetVoidPtr(id, s);
-	}
-	return s;
+	return g_shake_pool.GetOrAddByKey(id);
 }
 
 // Simple pseudo-random based on ID and time
@@ -4043,10 +8357,10 @@ void iam_trigger_shake(ImGuiID id) {
 
 float iam_shake(ImGuiID id, float intensity, float frequency, float decay_time, float dt) {
 	using namespace iam_shake_detail;
-	dt *= iam_detail::g_time_scale;
+	dt *= iam_detail::current_time_scale();
 	shake_state* s = get_shake(id);
 
-	if (s->last_frame != iam_detail::g_frame) {
+	if (s->last_frame != iam_detail::g_frame && !iam_detail::domain_paused(iam_detail::g_domain)) {
 		if (s->triggered) {
 			s->time_since_trigger += dt;
 		}
@@ -4145,10 +8459,10 @@ ImVec4 iam_shake_color(ImGuiID id, ImVec4 base_color, ImVec4 intensity, float fr
 
 float iam_wiggle(ImGuiID id, float amplitude, float frequency, float dt) {
 	using namespace iam_shake_detail;
-	dt *= iam_detail::g_time_scale;
+	dt *= iam_detail::current_time_scale();
 	shake_state* s = get_shake(id);
 
-	if (s->last_frame != iam_detail::g_frame) {
+	if (s->last_frame != iam_detail::g_frame && !iam_detail::domain_paused(iam_detail::g_domain)) {
 		s->noise_time += dt;
 		s->last_frame = iam_detail::g_frame;
 	}
@@ -4890,6 +9204,7 @@ ImVec2 iam_tween_path(ImGuiID id, ImGuiID channel_id, ImGuiID path_id, float dur
 	// Use float channel to track progress (0 to 1)
 	ImGuiID key = make_key(id, channel_id);
 	float_chan* c = g_float.get(key);
+	enter_domain(c);  // Time domain clock (iam_push_time_domain)
 
 	// Check if target changed (always 1.0 for path progress)
 	float target = 1.0f;
@@ -4952,6 +9267,7 @@ float iam_tween_path_angle(ImGuiID id, ImGuiID channel_id, ImGuiID path_id, floa
 	ImGuiID angle_channel = ImHashStr("_angle", 0, channel_id);
 	ImGuiID key = make_key(id, angle_channel);
 	float_chan* c = g_float.get(key);
+	enter_domain(c);  // Time domain clock (iam_push_time_domain)
 
 	float target = 1.0f;
 	bool changed = (c->target != target);
@@ -5239,6 +9555,7 @@ ImVec2 iam_tween_path_morph(ImGuiID id, ImGuiID channel_id, ImGuiID path_a, ImGu
 	// Animate path progress (0 to 1)
 	ImGuiID path_key = make_key(id, path_ch);
 	float_chan* path_c = g_float.get(path_key);
+	enter_domain(path_c);
 
 	// Check if path tween needs update
 	float path_target = 1.0f;
@@ -5255,6 +9572,7 @@ ImVec2 iam_tween_path_morph(ImGuiID id, ImGuiID channel_id, ImGuiID path_a, ImGu
 	// Animate morph blend
 	ImGuiID blend_key = make_key(id, blend_ch);
 	float_chan* blend_c = g_float.get(blend_key);
+	enter_domain(blend_c);
 
 	// Check if blend tween needs update
 	if (fabsf(blend_c->target - target_blend) > 1e-6f || blend_c->progress() >= 1.0f) {
@@ -6194,7 +10512,7 @@ float iam_noise_channel_float(ImGuiID id, float frequency, float amplitude, iam_
 	using namespace iam_noise_detail;
 	noise_state* s = get_noise_state(id);
 
-	s->time += dt;
+	if (!iam_detail::domain_paused(iam_detail::g_domain)) s->time += dt * iam_detail::current_time_scale();
 	float noise_val = iam_noise_2d(s->time * frequency, 0.0f, opts);
 	return noise_val * amplitude;
 }
@@ -6203,7 +10521,7 @@ ImVec2 iam_noise_channel_vec2(ImGuiID id, ImVec2 frequency, ImVec2 amplitude, ia
 	using namespace iam_noise_detail;
 	noise_state* s = get_noise_state(id);
 
-	s->time += dt;
+	if (!iam_detail::domain_paused(iam_detail::g_domain)) s->time += dt * iam_detail::current_time_scale();
 	float nx = iam_noise_2d(s->time * frequency.x, 0.0f, opts);
 	float ny = iam_noise_2d(s->time * frequency.y, 100.0f, opts); // Offset Y to get different values
 	return ImVec2(nx * amplitude.x, ny * amplitude.y);
@@ -6213,7 +10531,7 @@ ImVec4 iam_noise_channel_vec4(ImGuiID id, ImVec4 frequency, ImVec4 amplitude, ia
 	using namespace iam_noise_detail;
 	noise_state* s = get_noise_state(id);
 
-	s->time += dt;
+	if (!iam_detail::domain_paused(iam_detail::g_domain)) s->time += dt * iam_detail::current_time_scale();
 	float nx = iam_noise_2d(s->time * frequency.x, 0.0f, opts);
 	float ny = iam_noise_2d(s->time * frequency.y, 100.0f, opts);
 	float nz = iam_noise_2d(s->time * frequency.z, 200.0f, opts);
@@ -6502,6 +10820,7 @@ struct gradient_chan {
 	int color_space;
 	unsigned last_seen_frame;
 	unsigned sleeping;
+	int domain;  // Time domain slot
 
 	gradient_chan() {
 		dur = 1e-6f; t = 1.0f; start_time = 0;
@@ -6510,13 +10829,14 @@ struct gradient_chan {
 		color_space = iam_col_oklab;
 		last_seen_frame = 0;
 		sleeping = 1;
+		domain = 0;
 	}
 
 	void set(iam_gradient const& trg, float d, iam_ease_desc const& e, int pol, int cs) {
 		start = current;
 		target = trg;
 		dur = (d <= 1e-6f ? 1e-6f : d);
-		start_time = iam_detail::g_global_time;
+		start_time = iam_detail::domain_time(domain);
 		t = 0;
 		ez = e;
 		policy = pol;
@@ -6526,7 +10846,7 @@ struct gradient_chan {
 
 	float progress() {
 		if (sleeping) { t = 1.0f; return 1.0f; }
-		t = (float)((iam_detail::g_global_time - start_time) / dur);
+		t = (float)((iam_detail::domain_time(domain) - start_time) / dur);
 		if (t < 0.f) t = 0.f; else if (t > 1.f) t = 1.f;
 		return t;
 	}
@@ -6555,6 +10875,7 @@ iam_gradient iam_tween_gradient(ImGuiID id, ImGuiID channel_id, iam_gradient con
 	ImGuiID key = iam_detail::make_key(id, channel_id);
 	gradient_chan* c = g_gradient_pool.GetOrAddByKey(key);
 	c->last_seen_frame = g_gradient_frame;
+	if (iam_detail::enter_domain(c)) return c->current;  // Paused time domain
 
 	// Fast path: sleeping and target unchanged
 	if (c->sleeping && c->target.stop_count() == target.stop_count()) {
@@ -6769,6 +11090,7 @@ struct transform_chan {
 	int rotation_mode;
 	unsigned last_seen_frame;
 	unsigned sleeping;
+	int domain;  // Time domain slot
 
 	transform_chan() : current(), start(), target() {
 		dur = 1e-6f; t = 1.0f; start_time = 0;
@@ -6777,13 +11099,14 @@ struct transform_chan {
 		rotation_mode = iam_rotation_shortest;
 		last_seen_frame = 0;
 		sleeping = 1;
+		domain = 0;
 	}
 
 	void set(iam_transform const& trg, float d, iam_ease_desc const& e, int pol, int rot_mode) {
 		start = current;
 		target = trg;
 		dur = (d <= 1e-6f ? 1e-6f : d);
-		start_time = iam_detail::g_global_time;
+		start_time = iam_detail::domain_time(domain);
 		t = 0;
 		ez = e;
 		policy = pol;
@@ -6793,7 +11116,7 @@ struct transform_chan {
 
 	float progress() {
 		if (sleeping) { t = 1.0f; return 1.0f; }
-		t = (float)((iam_detail::g_global_time - start_time) / dur);
+		t = (float)((iam_detail::domain_time(domain) - start_time) / dur);
 		if (t < 0.f) t = 0.f; else if (t > 1.f) t = 1.f;
 		return t;
 	}
@@ -6832,13 +11155,14 @@ iam_transform iam_tween_transform(ImGuiID id, ImGuiID channel_id, iam_transform
 		c->target = target;
 		c->dur = 1e-6f;
 		c->t = 1.0f;
-		c->start_time = iam_detail::g_global_time;
+		c->start_time = iam_detail::domain_time(c->domain);
 		c->ez = ez;
 		c->policy = policy;
 		c->rotation_mode = rotation_mode;
 		c->sleeping = 1;
 	}
 	c->last_seen_frame = g_transform_frame;
+	if (iam_detail::enter_domain(c)) return c->current;  // Paused time domain
 
 	// Fast path: sleeping and target unchanged
 	if (c->sleeping) {
@@ -6877,6 +11201,432 @@ iam_transform iam_tween_transform(ImGuiID id, ImGuiID channel_id, iam_transform
 	return c->current;
 }
 
+// ----------------------------------------------------
+// Snapshots - the live animation state as one relocatable blob
+// ----------------------------------------------------
+// Layout (offsets from the blob start, sections 16-byte aligned, native endianness):
+//   iam_snapshot_header, including the section table
+//   per section: count records of stride bytes. Plain-data runtime state (tween channels, oscillator, shake
+//   and scroll state, time domains) is stored as the runtime struct itself, so saving and loading are one copy
+//   per record. A stride that differs from this build's struct rejects the blob (layout changed).
+// Clip instances keep their playback state; their values are evaluated again on load.
+
+namespace iam_snapshot_detail {
+
+static char const IAM_SNAPSHOT_MAGIC[4] = { 'I', 'A', 'M', 'S' };
+static ImU32 const IAM_SNAPSHOT_VERSION = 1;
+
+enum snap_section {
+	SNAP_FLOAT,
+	SNAP_VEC2,
+	SNAP_VEC4,
+	SNAP_INT,
+	SNAP_COLOR,
+	SNAP_TRANSFORM,
+	SNAP_OSC,
+	SNAP_SHAKE,
+	SNAP_NOISE,
+	SNAP_SCROLL,
+	SNAP_DOMAIN,
+	SNAP_INSTANCE,
+	SNAP_FLOATS,		// Variation caches referenced by snap_instance
+	SNAP_SECTION_COUNT
+};
+
+enum snap_instance_flags {
+	SNAP_INST_PLAYING	= 1 << 0,
+	SNAP_INST_PAUSED	= 1 << 1,
+	SNAP_INST_BEGUN		= 1 << 2,
+	SNAP_INST_REALTIME	= 1 << 3,
+	SNAP_INST_HIDDEN	= 1 << 4
+};
+
+struct snap_section_desc {
+	ImU32		offset;
+	ImU32		count;
+	ImU32		stride;
+	ImU32		frame;			// Frame counter last_seen_frame / last_frame are relative to
+};
+
+struct iam_snapshot_header {
+	char		magic[4];
+	ImU32		version;
+	ImU32		total_size;
+	ImU32		checksum;		// ImHashData of the whole snapshot, hashed with this field zeroed
+	double		global_time;
+	float		time_scale;
+	ImU32		clip_frame;		// iam_clip_system::frame_counter
+	float		tick_accum;
+	float		tick_alpha;
+	ImU32		tick_serial;
+	ImU32		reserved;
+	snap_section_desc sections[SNAP_SECTION_COUNT];
+};
+
+template<typename T>
+struct snap_keyed {
+	ImGuiID		key;
+	T			data;
+};
+
+struct snap_instance {
+	ImGuiID		inst_id;
+	ImGuiID		clip_id;
+	float		time;
+	float		time_scale;
+	float		weight;
+	float		delay_left;
+	int			flags;			// snap_instance_flags
+	int			dir_sign;
+	int			loops_left;
+	float		prev_time;
+	ImGuiID		chain_next_clip_id;
+	ImGuiID		chain_next_inst_id;
+	float		chain_delay;
+	ImGuiID		playlist_id;
+	int			playlist_index;
+	int			current_loop;
+	ImU32		var_rng_state;
+	int			var_loop;
+	ImU32		var_offset;		// First float in SNAP_FLOATS
+	ImU32		var_count;
+	int			lane_count;
+	float		lane_stagger;
+	float		lane_clock;
+	int			priority;
+	int			time_domain;	// Slot in the SNAP_DOMAIN table
+	ImGuiID		sm_player_id;
+};
+
+static ImU32 snap_align16(ImU32 v) { return (v + 15) & ~(ImU32)15; }
+
+// Record size of each section in this build
+static ImU32 snap_stride(int section) {
+	switch (section) {
+		case SNAP_FLOAT:		return sizeof(snap_keyed<iam_detail::float_chan>);
+		case SNAP_VEC2:			return sizeof(snap_keyed<iam_detail::vec2_chan>);
+		case SNAP_VEC4:			return sizeof(snap_keyed<iam_detail::vec4_chan>);
+		case SNAP_INT:			return sizeof(snap_keyed<iam_detail::int_chan>);
+		case SNAP_COLOR:		return sizeof(snap_keyed<iam_detail::color_chan>);
+		case SNAP_TRANSFORM:	return sizeof(snap_keyed<iam_transform_detail::transform_chan>);
+		case SNAP_OSC:			return sizeof(snap_keyed<iam_osc_detail::osc_state>);
+		case SNAP_SHAKE:		return sizeof(snap_keyed<iam_shake_detail::shake_state>);
+		case SNAP_NOISE:		return sizeof(snap_keyed<iam_noise_detail::noise_state>);
+		case SNAP_SCROLL:		return sizeof(iam_scroll_detail::scroll_anim);
+		case SNAP_DOMAIN:		return sizeof(iam_detail::time_domain);
+		case SNAP_INSTANCE:		return sizeof(snap_instance);
+		default:				return sizeof(float);
+	}
+}
+
+// Records a section after offset and returns the end of its data
+static ImU32 snap_place(iam_snapshot_header* hdr, int section, ImU32 offset, ImU32 count, ImU32 frame) {
+	snap_section_desc& s = hdr->sections[section];
+	s.offset = snap_align16(offset);
+	s.count = count;
+	s.stride = snap_stride(section);
+	s.frame = frame;
+	return s.offset + count * s.stride;
+}
+
+// Section table for the current state (the blob size is the end of the last section)
+static ImU32 snap_layout(iam_snapshot_header* hdr) {
+	using namespace iam_clip_detail;
+	memset(hdr, 0, sizeof(*hdr));
+	ImU32 var_floats = 0;
+	for (int i = 0; i < g_clip_sys.instances.slot_count; ++i) {
+		iam_instance_data const* inst = g_clip_sys.instances.at(i);
+		if (inst->inst_id != 0 && !inst->pending_load && inst->var_loop >= 0) var_floats += (ImU32)inst->var_keys.Size;
+	}
+	ImU32 end = sizeof(iam_snapshot_header);
+	end = snap_place(hdr, SNAP_FLOAT, end, iam_detail::g_float.pool.GetAliveCount(), iam_detail::g_float.frame);
+	end = snap_place(hdr, SNAP_VEC2, end, iam_detail::g_vec2.pool.GetAliveCount(), iam_detail::g_vec2.frame);
+	end = snap_place(hdr, SNAP_VEC4, end, iam_detail::g_vec4.pool.GetAliveCount(), iam_detail::g_vec4.frame);
+	end = snap_place(hdr, SNAP_INT, end, iam_detail::g_int.pool.GetAliveCount(), iam_detail::g_int.frame);
+	end = snap_place(hdr, SNAP_COLOR, end, iam_detail::g_color.pool.GetAliveCount(), iam_detail::g_color.frame);
+	end = snap_place(hdr, SNAP_TRANSFORM, end, iam_transform_detail::g_transform_pool.GetAliveCount(), iam_transform_detail::g_transform_frame);
+	end = snap_place(hdr, SNAP_OSC, end, iam_osc_detail::g_osc_pool.GetAliveCount(), iam_detail::g_frame);
+	end = snap_place(hdr, SNAP_SHAKE, end, iam_shake_detail::g_shake_pool.GetAliveCount(), iam_detail::g_frame);
+	end = snap_place(hdr, SNAP_NOISE, end, iam_noise_detail::g_noise_states.GetAliveCount(), iam_detail::g_frame);
+	end = snap_place(hdr, SNAP_SCROLL, end, iam_scroll_detail::g_scroll_anims.Size, iam_detail::g_frame);
+	end = snap_place(hdr, SNAP_DOMAIN, end, iam_detail::g_domains.Size, 0);
+	end = snap_place(hdr, SNAP_INSTANCE, end, g_clip_sys.instances.live_count, g_clip_sys.frame_counter);
+	end = snap_place(hdr, SNAP_FLOATS, end, var_floats, 0);
+	return snap_align16(end);
+}
+
+// Pool entries are written in map (key) order, so loading appends to the map without shifting it
+template<typename T>
+static ImU32 snap_save_pool(ImPool<T>& pool, unsigned char* dst) {
+	ImU32 count = 0;
+	snap_keyed<T> rec;
+	for (int i = 0; i < pool.Map.Data.Size; ++i) {
+		T* c = pool.TryGetMapData(i);
+		if (!c) continue;
+		rec.key = pool.Map.Data[i].key;
+		rec.data = *c;
+		memcpy(dst + count * sizeof(rec), (void const*)&rec, sizeof(rec));
+		count++;
+	}
+	return count;
+}
+
+// Replace a pool's contents with one reserve: no allocation per entry
+template<typename T>
+static void snap_load_pool(ImPool<T>& pool, unsigned char const* src, ImU32 count) {
+	pool.Clear();
+	pool.Reserve((int)count);
+	snap_keyed<T> rec;
+	for (ImU32 i = 0; i < count; ++i) {
+		memcpy((void*)&rec, src + i * sizeof(rec), sizeof(rec));
+		*pool.GetOrAddByKey(rec.key) = rec.data;
+	}
+}
+
+static void snap_save_instance(iam_instance_data const* inst, snap_instance* out, ImU32* var_cursor, unsigned char* floats) {
+	memset(out, 0, sizeof(*out));
+	out->inst_id = inst->inst_id;
+	out->clip_id = inst->clip_id;
+	out->time = inst->time;
+	out->time_scale = inst->time_scale;
+	out->weight = inst->weight;
+	out->delay_left = inst->delay_left;
+	out->flags = (inst->playing ? SNAP_INST_PLAYING : 0) | (inst->paused ? SNAP_INST_PAUSED : 0) |
+		(inst->begin_called ? SNAP_INST_BEGUN : 0) | (inst->realtime ? SNAP_INST_REALTIME : 0) | (inst->hidden ? SNAP_INST_HIDDEN : 0);
+	out->dir_sign = inst->dir_sign;
+	out->loops_left = inst->loops_left;
+	out->prev_time = inst->prev_time;
+	out->chain_next_clip_id = inst->chain_next_clip_id;
+	out->chain_next_inst_id = inst->chain_next_inst_id;
+	out->chain_delay = inst->chain_delay;
+	out->playlist_id = inst->playlist_id;
+	out->playlist_index = inst->playlist_index;
+	out->current_loop = inst->current_loop;
+	out->var_rng_state = inst->var_rng_state;
+	out->var_loop = -1;
+	if (inst->var_loop >= 0 && inst->var_keys.Size > 0) {
+		// The resolved variation cache is kept as is: re-resolving would draw new random values
+		out->var_loop = inst->var_loop;
+		out->var_offset = *var_cursor;
+		out->var_count = (ImU32)inst->var_keys.Size;
+		memcpy(floats + *var_cursor * sizeof(float), inst->var_keys.Data, sizeof(float) * inst->var_keys.Size);
+		*var_cursor += out->var_count;
+	}
+	out->lane_count = inst->lane_count;
+	out->lane_stagger = inst->lane_stagger;
+	out->lane_clock = inst->lane_clock;
+	out->priority = inst->priority;
+	out->time_domain = inst->time_domain;
+	out->sm_player_id = inst->sm_player_id;
+}
+
+// Recreate an instance from its record; returns false if its clip is not registered
+static bool snap_load_instance(snap_instance const& r, unsigned char const* floats, ImU32 float_count, int domain_count) {
+	using namespace iam_clip_detail;
+	iam_clip_data* clip = find_clip(r.clip_id);
+	if (!clip || r.inst_id == 0 || find_instance(r.inst_id)) return false;
+	int slot = g_clip_sys.instances.alloc();
+	iam_instance_data* inst = g_clip_sys.instances.at(slot);
+	inst->inst_id = r.inst_id;
+	g_clip_sys.inst_map.SetInt(r.inst_id, slot + 1);
+
+	inst->clip_id = r.clip_id;
+	inst->time = r.time;
+	inst->time_scale = r.time_scale;
+	inst->weight = r.weight;
+	inst->delay_left = r.delay_left;
+	inst->playing = (r.flags & SNAP_INST_PLAYING) != 0;
+	inst->paused = (r.flags & SNAP_INST_PAUSED) != 0;
+	inst->begin_called = (r.flags & SNAP_INST_BEGUN) != 0;
+	inst->realtime = (r.flags & SNAP_INST_REALTIME) != 0;
+	inst->hidden = (r.flags & SNAP_INST_HIDDEN) != 0;
+	inst->dir_sign = r.dir_sign < 0 ? -1 : 1;
+	inst->loops_left = r.loops_left;
+	inst->prev_time = r.prev_time;
+	inst->chain_next_clip_id = r.chain_next_clip_id;
+	inst->chain_next_inst_id = r.chain_next_inst_id;
+	inst->chain_delay = r.chain_delay;
+	inst->playlist_id = find_playlist(r.playlist_id) ? r.playlist_id : 0;
+	inst->playlist_index = inst->playlist_id ? r.playlist_index : 0;
+	inst->current_loop = r.current_loop;
+	inst->var_rng_state = r.var_rng_state;
+	inst->priority = r.priority;
+	inst->time_domain = r.time_domain > 0 && r.time_domain <= domain_count ? r.time_domain : 0;
+	inst->sm_player_id = find_sm_player(r.sm_player_id) ? r.sm_player_id : 0;
+	inst->last_seen_frame = g_clip_sys.frame_counter;
+	if (r.var_loop >= 0 && (int)r.var_count == clip->var_value_count && r.var_offset + r.var_count <= float_count) {
+		inst->var_keys.resize((int)r.var_count);
+		memcpy(inst->var_keys.Data, floats + r.var_offset * sizeof(float), sizeof(float) * r.var_count);
+		inst->var_loop = r.var_loop;
+		inst->var_layout = clip->key_version;
+	}
+
+	place_marker_cursor(inst, clip, inst->prev_time);
+	if (r.lane_count > 0) {
+		inst->lane_count = r.lane_count;
+		inst->lane_stagger = r.lane_stagger;
+		inst->lane_clock = r.lane_clock;
+		inst->lane_time.resize(inst->lane_count);
+		compute_lane_times(clip, inst);
+		eval_instance_lanes(clip, inst);
+	} else {
+		eval_instance_tracks(clip, inst->time, inst);
+	}
+	return true;
+}
+
+// Checksum covering the header (section table included) and every byte after it
+static ImU32 snap_checksum(unsigned char const* blob, ImU32 total_size) {
+	iam_snapshot_header hdr;
+	memcpy(&hdr, blob, sizeof(hdr));
+	hdr.checksum = 0;
+	return ImHashData(blob + sizeof(hdr), total_size - sizeof(hdr), ImHashData(&hdr, sizeof(hdr)));
+}
+
+} // namespace iam_snapshot_detail
+
+size_t iam_snapshot_size() {
+	iam_snapshot_detail::iam_snapshot_header hdr;
+	return iam_snapshot_detail::snap_layout(&hdr);
+}
+
+iam_result iam_snapshot_save(void* buffer, size_t capacity, size_t* out_size) {
+	using namespace iam_snapshot_detail;
+	using namespace iam_clip_detail;
+	iam_snapshot_header hdr;
+	ImU32 total = snap_layout(&hdr);
+	if (out_size) *out_size = total;
+	if (!buffer) return iam_err_bad_arg;
+	if (capacity < total) return iam_err_no_mem;
+
+	unsigned char* dst = (unsigned char*)buffer;
+	memset(dst, 0, total);  // Padding and alignment gaps
+	memcpy(hdr.magic, IAM_SNAPSHOT_MAGIC, 4);
+	hdr.version = IAM_SNAPSHOT_VERSION;
+	hdr.total_size = total;
+	hdr.global_time = iam_detail::g_global_time;
+	hdr.time_scale = iam_detail::g_time_scale;
+	hdr.clip_frame = g_clip_sys.frame_counter;
+	hdr.tick_accum = g_clip_sys.tick_accum;
+	hdr.tick_alpha = g_clip_sys.tick_alpha;
+	hdr.tick_serial = g_clip_sys.tick_serial;
+
+	snap_save_pool(iam_detail::g_float.pool, dst + hdr.sections[SNAP_FLOAT].offset);
+	snap_save_pool(iam_detail::g_vec2.pool, dst + hdr.sections[SNAP_VEC2].offset);
+	snap_save_pool(iam_detail::g_vec4.pool, dst + hdr.sections[SNAP_VEC4].offset);
+	snap_save_pool(iam_detail::g_int.pool, dst + hdr.sections[SNAP_INT].offset);
+	snap_save_pool(iam_detail::g_color.pool, dst + hdr.sections[SNAP_COLOR].offset);
+	snap_save_pool(iam_transform_detail::g_transform_pool, dst + hdr.sections[SNAP_TRANSFORM].offset);
+	snap_save_pool(iam_osc_detail::g_osc_pool, dst + hdr.sections[SNAP_OSC].offset);
+	snap_save_pool(iam_shake_detail::g_shake_pool, dst + hdr.sections[SNAP_SHAKE].offset);
+	snap_save_pool(iam_noise_detail::g_noise_states, dst + hdr.sections[SNAP_NOISE].offset);
+	if (iam_scroll_detail::g_scroll_anims.Size > 0)
+		memcpy(dst + hdr.sections[SNAP_SCROLL].offset, iam_scroll_detail::g_scroll_anims.Data, sizeof(iam_scroll_detail::scroll_anim) * iam_scroll_detail::g_scroll_anims.Size);
+	if (iam_detail::g_domains.Size > 0)
+		memcpy(dst + hdr.sections[SNAP_DOMAIN].offset, iam_detail::g_domains.Data, sizeof(iam_detail::time_domain) * iam_detail::g_domains.Size);
+
+	// Instances in slot order; pending ones (clip still streaming in) are left out
+	ImU32 count = 0, var_cursor = 0;
+	unsigned char* floats = dst + hdr.sections[SNAP_FLOATS].offset;
+	for (int i = 0; i < g_clip_sys.instances.slot_count; ++i) {
+		iam_instance_data const* inst = g_clip_sys.instances.at(i);
+		if (inst->inst_id == 0 || inst->pending_load) continue;
+		snap_instance rec;
+		snap_save_instance(inst, &rec, &var_cursor, floats);
+		memcpy(dst + hdr.sections[SNAP_INSTANCE].offset + count * sizeof(rec), &rec, sizeof(rec));
+		count++;
+	}
+	hdr.sections[SNAP_INSTANCE].count = count;
+
+	hdr.checksum = 0;
+	memcpy(dst, &hdr, sizeof(hdr));
+	hdr.checksum = snap_checksum(dst, total);
+	memcpy(dst, &hdr, sizeof(hdr));
+	return iam_ok;
+}
+
+iam_result iam_snapshot_load(void const* data, size_t size) {
+	using namespace iam_snapshot_detail;
+	using namespace iam_clip_detail;
+	if (!data || size < sizeof(iam_snapshot_header)) return iam_err_bad_arg;
+	unsigned char const* src = (unsigned char const*)data;
+	iam_snapshot_header hdr;
+	memcpy(&hdr, src, sizeof(hdr));
+	if (memcmp(hdr.magic, IAM_SNAPSHOT_MAGIC, 4) != 0 || hdr.version != IAM_SNAPSHOT_VERSION) return iam_err_bad_arg;
+	if (hdr.total_size < sizeof(hdr) || hdr.total_size > size) return iam_err_bad_arg;
+	if (hdr.checksum != snap_checksum(src, hdr.total_size)) return iam_err_bad_arg;
+
+	// A record size other than this build's means the blob was written with another layout
+	for (int s = 0; s < SNAP_SECTION_COUNT; ++s) {
+		snap_section_desc const& sec = hdr.sections[s];
+		if (sec.stride != snap_stride(s)) return iam_err_bad_arg;
+		if (sec.offset < sizeof(hdr) || sec.offset > hdr.total_size || (sec.offset & 15) != 0) return iam_err_bad_arg;
+		if (sec.count > (hdr.total_size - sec.offset) / sec.stride) return iam_err_bad_arg;
+	}
+
+	if (!g_clip_sys.initialized) iam_clip_init();
+
+	// Global time and time domains (slots are kept, channels and instances refer to them)
+	iam_detail::g_global_time = hdr.global_time;
+	iam_detail::g_time_scale = hdr.time_scale;
+	snap_section_desc const& dom = hdr.sections[SNAP_DOMAIN];
+	iam_detail::g_domains.resize((int)dom.count);
+	iam_detail::g_domain_map.Clear();
+	if (dom.count > 0) memcpy(iam_detail::g_domains.Data, src + dom.offset, sizeof(iam_detail::time_domain) * dom.count);
+	for (int d = 0; d < iam_detail::g_domains.Size; ++d)
+		if (iam_detail::g_domains[d].id != 0) iam_detail::g_domain_map.SetInt(iam_detail::g_domains[d].id, d + 1);
+	if (iam_detail::g_domain > iam_detail::g_domains.Size) iam_detail::g_domain = 0;
+	for (int d = 0; d < iam_detail::g_domain_stack.Size; ++d)
+		if (iam_detail::g_domain_stack[d] > iam_detail::g_domains.Size) iam_detail::g_domain_stack[d] = 0;
+
+	// Tween channels and procedural state
+	snap_load_pool(iam_detail::g_float.pool, src + hdr.sections[SNAP_FLOAT].offset, hdr.sections[SNAP_FLOAT].count);
+	snap_load_pool(iam_detail::g_vec2.pool, src + hdr.sections[SNAP_VEC2].offset, hdr.sections[SNAP_VEC2].count);
+	snap_load_pool(iam_detail::g_vec4.pool, src + hdr.sections[SNAP_VEC4].offset, hdr.sections[SNAP_VEC4].count);
+	snap_load_pool(iam_detail::g_int.pool, src + hdr.sections[SNAP_INT].offset, hdr.sections[SNAP_INT].count);
+	snap_load_pool(iam_detail::g_color.pool, src + hdr.sections[SNAP_COLOR].offset, hdr.sections[SNAP_COLOR].count);
+	snap_load_pool(iam_transform_detail::g_transform_pool, src + hdr.sections[SNAP_TRANSFORM].offset, hdr.sections[SNAP_TRANSFORM].count);
+	snap_load_pool(iam_osc_detail::g_osc_pool, src + hdr.sections[SNAP_OSC].offset, hdr.sections[SNAP_OSC].count);
+	snap_load_pool(iam_shake_detail::g_shake_pool, src + hdr.sections[SNAP_SHAKE].offset, hdr.sections[SNAP_SHAKE].count);
+	snap_load_pool(iam_noise_detail::g_noise_states, src + hdr.sections[SNAP_NOISE].offset, hdr.sections[SNAP_NOISE].count);
+	iam_detail::g_float.frame = hdr.sections[SNAP_FLOAT].frame;
+	iam_detail::g_vec2.frame = hdr.sections[SNAP_VEC2].frame;
+	iam_detail::g_vec4.frame = hdr.sections[SNAP_VEC4].frame;
+	iam_detail::g_int.frame = hdr.sections[SNAP_INT].frame;
+	iam_detail::g_color.frame = hdr.sections[SNAP_COLOR].frame;
+	iam_transform_detail::g_transform_frame = hdr.sections[SNAP_TRANSFORM].frame;
+	iam_detail::g_frame = hdr.sections[SNAP_OSC].frame;
+	// Gradient tweens are not captured: they settle at their target in the default domain
+	for (int i = 0; i < iam_gradient_detail::g_gradient_pool.GetMapSize(); ++i) {
+		if (iam_gradient_detail::gradient_chan* c = iam_gradient_detail::g_gradient_pool.TryGetMapData(i)) {
+			c->current = c->target;
+			c->sleeping = 1;
+			c->domain = 0;
+		}
+	}
+	snap_section_desc const& scroll = hdr.sections[SNAP_SCROLL];
+	iam_scroll_detail::g_scroll_anims.resize((int)scroll.count);
+	if (scroll.count > 0) memcpy(iam_scroll_detail::g_scroll_anims.Data, src + scroll.offset, sizeof(iam_scroll_detail::scroll_anim) * scroll.count);
+
+	// Clip instances replace the live ones (slots and their buffers are reused)
+	for (int i = 0; i < g_clip_sys.instances.slot_count; ++i) {
+		iam_instance_data* inst = g_clip_sys.instances.at(i);
+		if (inst->inst_id != 0) free_instance(inst);
+	}
+	g_clip_sys.frame_counter = hdr.clip_frame;
+	g_clip_sys.tick_accum = hdr.tick_accum;
+	g_clip_sys.tick_alpha = hdr.tick_alpha;
+	g_clip_sys.tick_serial = hdr.tick_serial;
+	snap_section_desc const& insts = hdr.sections[SNAP_INSTANCE];
+	snap_section_desc const& floats = hdr.sections[SNAP_FLOATS];
+	for (ImU32 i = 0; i < insts.count; ++i) {
+		snap_instance rec;
+		memcpy(&rec, src + insts.offset + i * sizeof(rec), sizeof(rec));
+		snap_load_instance(rec, src + floats.offset, floats.count, iam_detail::g_domains.Size);
+	}
+	return iam_ok;
+}
+
 // ----------------------------------------------------
 // Unified Inspector (combines Debug Window + Animation Inspector)
 // ----------------------------------------------------
@@ -6913,6 +11663,18 @@ void iam_show_unified_inspector(bool* p_open) {
 				if (ImGui::SmallButton("1x")) iam_detail::g_time_scale = 1.0f;
 				ImGui::SameLine();
 				if (ImGui::SmallButton("2x")) iam_detail::g_time_scale = 2.0f;
+
+				for (int i = 0; i < iam_detail::g_domains.Size; ++i) {
+					iam_detail::time_domain& d = iam_detail::g_domains[i];
+					if (d.id == 0) continue;
+					ImGui::PushID((int)d.id);
+					ImGui::Checkbox("##paused", &d.paused);
+					ImGui::SameLine();
+					ImGui::SliderFloat("##scale", &d.scale, 0.0f, 2.0f, "%.2fx");
+					ImGui::SameLine();
+					ImGui::Text("Domain 0x%08X  %.2fs%s", d.id, d.time - d.origin, d.paused ? " (paused)" : "");
+					ImGui::PopID();
+				}
 			}
 
 			// Tween stats
@@ -6931,12 +11693,42 @@ void iam_show_unified_inspector(bool* p_open) {
 				            iam_detail::g_color.pool.GetAliveCount();
 				ImGui::Unindent();
 				ImGui::Text("Total:  %d", total);
+				bool cull = iam_get_tween_culling();
+				if (ImGui::Checkbox("Cull Tweens In Hidden Windows", &cull)) {
+					iam_set_tween_culling(cull);
+				}
+				ImGui::Text("Tweens Culled:  %d", iam_get_tweens_culled());
 			}
 
 			// Clip stats
 			if (ImGui::CollapsingHeader("Clip Stats")) {
 				ImGui::Text("Registered Clips: %d", iam_clip_detail::g_clip_sys.clips.Size);
-				ImGui::Text("Active Instances: %d", iam_clip_detail::g_clip_sys.instances.Size);
+				ImGui::Text("Active Instances: %d", iam_clip_detail::g_clip_sys.instances.live_count);
+				ImGui::Text("Instance Slots:   %d (%d free)", iam_clip_detail::g_clip_sys.instances.slot_count, iam_clip_detail::g_clip_sys.instances.free_slots.Size);
+				ImGui::Text("State Machines:   %d (%d players, %d fading)", iam_clip_detail::g_clip_sys.machines.Size, iam_clip_detail::g_clip_sys.players.Size, iam_clip_detail::g_clip_sys.players_fading.Size);
+				bool lazy = iam_clip_get_lazy_eval();
+				if (ImGui::Checkbox("Lazy Track Evaluation", &lazy)) {
+					iam_clip_set_lazy_eval(lazy);
+				}
+				int evaluated = 0, skipped = 0;
+				iam_clip_get_eval_stats(&evaluated, &skipped);
+				ImGui::Text("Tracks Evaluated: %d", evaluated);
+				ImGui::Text("Tracks Skipped:   %d", skipped);
+				ImGui::Text("Instances Culled: %d", iam_clip_get_culled_count());
+				bool cache = iam_clip_detail::g_clip_sys.eval_cache;
+				if (ImGui::Checkbox("Shared Evaluation Cache", &cache)) {
+					iam_clip_set_eval_cache(cache, iam_clip_detail::g_clip_sys.eval_cache_quantum);
+				}
+				int hits = 0, misses = 0;
+				iam_clip_get_eval_cache_stats(&hits, &misses);
+				ImGui::Text("Cache Hits/Misses: %d / %d", hits, misses);
+				if (iam_clip_get_update_budget() > 0.0f) {
+					iam_clip_budget_stats bs;
+					iam_clip_get_budget_stats(&bs);
+					ImGui::Text("Budget: %.0f us (used %.1f us)", iam_clip_get_update_budget(), bs.used_us);
+					ImGui::Text("Evaluated/Deferred: %d / %d (max wait %d)", bs.evaluated, bs.deferred, bs.max_wait);
+					ImGui::Text("Overrun Updates: %u", bs.overrun_updates);
+				}
 			}
 
 			ImGui::EndTabItem();
@@ -6946,14 +11738,17 @@ void iam_show_unified_inspector(bool* p_open) {
 		if (ImGui::BeginTabItem("Animations")) {
 			// List active clips/instances
 			auto& instances = iam_clip_detail::g_clip_sys.instances;
-			if (instances.Size == 0) {
+			if (instances.live_count == 0) {
 				ImGui::TextDisabled("No active animation instances");
 			} else {
-				for (int i = 0; i < instances.Size; i++) {
-					auto& inst = instances[i];
+				for (int i = 0; i < instances.slot_count; i++) {
+					auto& inst = *instances.at(i);
+					if (inst.inst_id == 0) continue;  // Free slot
 					ImGui::PushID(i);
 					if (ImGui::TreeNode("Instance", "Instance %d (clip 0x%08X)", i, inst.clip_id)) {
 						ImGui::Text("Clip ID: 0x%08X", inst.clip_id);
+						if (inst.playlist_id != 0)
+							ImGui::Text("Playlist: 0x%08X (entry %d)", inst.playlist_id, inst.playlist_index);
 						ImGui::Text("Time: %.2f", inst.time);
 						ImGui::Text("Playing: %s", inst.playing ? "Yes" : "No");
 						ImGui::Text("Loops Left: %d", inst.loops_left);
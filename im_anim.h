@@ -100,10 +100,29 @@ void iam_set_ease_lut_samples(int count);
 void  iam_set_global_time_scale(float scale);                                       // Set global time multiplier (1.0 = normal, 0.5 = half speed, 2.0 = double).
 float iam_get_global_time_scale();                                                  // Get current global time scale.
 
+// Time domains - independent clocks with their own scale (on top of the global one) and pause. Tweens, oscillators,
+// shake, wiggle and noise channels called between push/pop run on the domain; clip instances join the domain current at iam_play.
+// Paused domains are skipped by the update loops: their tweens hold their value and their instances do not advance.
+bool   iam_time_domain_create(ImGuiID domain_id, float scale = 1.0f);               // Create a domain (or set its scale); false for 0, the default domain.
+void   iam_time_domain_destroy(ImGuiID domain_id);                                  // Members fall back to the default domain.
+void   iam_time_domain_set_scale(ImGuiID domain_id, float scale);
+float  iam_time_domain_get_scale(ImGuiID domain_id);
+void   iam_time_domain_set_paused(ImGuiID domain_id, bool paused);
+bool   iam_time_domain_is_paused(ImGuiID domain_id);
+double iam_time_domain_time(ImGuiID domain_id);                                     // Scaled seconds the domain has run.
+void   iam_push_time_domain(ImGuiID domain_id);                                     // Unknown ids push the default domain.
+void   iam_pop_time_domain();
+
 // Lazy Initialization - defer channel creation until animation is needed
 void iam_set_lazy_init(bool enable);                                                // Enable/disable lazy initialization (default: true).
 bool iam_is_lazy_init_enabled();                                                    // Check if lazy init is enabled.
 
+// Tween culling - tweens called while the current window skips its items (collapsed, fully clipped) keep their last
+// value instead of easing; they catch up on the next visible call. Off by default.
+void iam_set_tween_culling(bool enable);                                            // Enable/disable tween culling.
+bool iam_get_tween_culling();                                                       // Check if tween culling is enabled.
+int iam_get_tweens_culled();                                                        // Tween calls culled during the previous frame.
+
 // Custom easing functions
 void iam_register_custom_ease(int slot, iam_ease_fn fn);                            // Register custom easing in slot 0-15. Use with iam_ease_custom_fn(slot).
 iam_ease_fn iam_get_custom_ease(int slot);                                          // Get registered custom easing function.
@@ -929,8 +948,8 @@ typedef void (*iam_marker_callback)(ImGuiID inst_id, ImGuiID marker_id, float ma
 // ----------------------------------------------------
 class iam_clip {
 public:
-	// Start building a new clip with the given ID
-	static iam_clip begin(ImGuiID clip_id);
+	// Start building a new clip with the given ID (key_count_hint pre-sizes storage for generated clips)
+	static iam_clip begin(ImGuiID clip_id, int key_count_hint = 0);
 
 	// Add keyframes for different channel types
 	iam_clip& key_float(ImGuiID channel, float time, float value, int ease_type = iam_ease_linear, float const* bezier4 = nullptr);
@@ -938,6 +957,7 @@ public:
 	iam_clip& key_vec4(ImGuiID channel, float time, ImVec4 value, int ease_type = iam_ease_linear, float const* bezier4 = nullptr);
 	iam_clip& key_int(ImGuiID channel, float time, int value, int ease_type = iam_ease_linear);
 	iam_clip& key_color(ImGuiID channel, float time, ImVec4 value, int color_space = iam_col_oklab, int ease_type = iam_ease_linear, float const* bezier4 = nullptr);
+	iam_clip& key_float_array(ImGuiID channel, float const* times, float const* values, int count, int ease_type = iam_ease_linear);  // Bulk float keys (one ease for all).
 
 	// Keyframes with repeat variation (value changes per loop iteration)
 	iam_clip& key_float_var(ImGuiID channel, float time, float value, iam_variation_float const& var, int ease_type = iam_ease_linear, float const* bezier4 = nullptr);
@@ -991,13 +1011,115 @@ private:
 	ImGuiID m_clip_id;
 };
 
+// Channel binding for iam_instance::get_all - maps a clip channel onto a member of a user struct
+struct iam_channel_binding {
+	ImGuiID		channel;	// Channel ID used when authoring the clip
+	int			type;		// iam_channel_type of the member (relative types map to their absolute type)
+	size_t		offset;		// Byte offset of the member in the destination struct
+};
+#define IAM_BIND(_TYPE, _MEMBER, _CHANNEL, _CHAN_TYPE) { (_CHANNEL), (_CHAN_TYPE), IM_OFFSETOF(_TYPE, _MEMBER) }
+
+// ----------------------------------------------------
+// Coroutine scripts (C++20) - sequence clips with co_await instead of polling is_playing() every frame
+// ----------------------------------------------------
+// Available when the compiler supports coroutines (define IAM_DISABLE_COROUTINES to leave them out).
+// A function returning iam_task runs right away until its first co_await; iam_clip_update resumes it once what it
+// awaits has happened. Suspended tasks cost nothing per update, and their frames come from a pooled allocator.
+//
+//   iam_task intro(ImGuiID id) {
+//       co_await iam_play(FADE_IN, id).completed();
+//       co_await iam_wait(0.5f);
+//       iam_play(MOVE, id);
+//       co_await iam_wait_marker(id, ImHashStr("halfway"));
+//       iam_play(PULSE, ImHashStr("pulse"));
+//   }
+#if !defined(IAM_DISABLE_COROUTINES) && defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && defined(__has_include)
+#if __has_include(<coroutine>)
+#define IAM_HAS_COROUTINES
+#endif
+#endif
+
+#ifdef IAM_HAS_COROUTINES
+#include <coroutine>
+
+// Used by the awaiters below; handles are std::coroutine_handle addresses
+namespace iam_task_detail {
+void* frame_alloc(size_t size);
+void frame_free(void* ptr, size_t size);
+unsigned task_register();
+void task_release(unsigned task_id);
+void wait_time(unsigned task_id, void* handle, float seconds);
+bool instance_active(ImGuiID instance_id);
+void wait_instance(unsigned task_id, void* handle, ImGuiID instance_id);
+void wait_marker(unsigned task_id, void* handle, ImGuiID instance_id, ImGuiID marker_id);
+}
+
+// Handle to a running script. Dropping it does not stop the script; the clip system owns suspended tasks.
+class iam_task {
+public:
+	struct promise_type {
+		unsigned id;
+		promise_type() : id(iam_task_detail::task_register()) {}
+		~promise_type() { iam_task_detail::task_release(id); }
+		iam_task get_return_object() { return iam_task(id); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { IM_ASSERT(0 && "Exception escaped an iam_task"); }
+		static void* operator new(size_t size) { return iam_task_detail::frame_alloc(size); }
+		static void operator delete(void* ptr, size_t size) { iam_task_detail::frame_free(ptr, size); }
+	};
+	typedef std::coroutine_handle<promise_type> handle_type;
+
+	iam_task() : m_id(0) {}
+	explicit iam_task(unsigned id) : m_id(id) {}
+	unsigned id() const { return m_id; }
+	bool running() const;                                                            // Not finished or cancelled yet.
+	void cancel();                                                                   // Destroy the task if it is suspended.
+
+private:
+	unsigned m_id;
+};
+
+// co_await iam_wait(seconds): resume after seconds of clip time (global time scale applies); 0 = next iam_clip_update
+struct iam_wait {
+	float seconds;
+	explicit iam_wait(float s) : seconds(s) {}
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(iam_task::handle_type h) { iam_task_detail::wait_time(h.promise().id, h.address(), seconds); }
+	void await_resume() const noexcept {}
+};
+
+// co_await inst.completed(): resume once the instance stops playing (completes, is stopped or destroyed)
+struct iam_await_instance {
+	ImGuiID instance_id;
+	explicit iam_await_instance(ImGuiID id) : instance_id(id) {}
+	bool await_ready() const { return !iam_task_detail::instance_active(instance_id); }
+	void await_suspend(iam_task::handle_type h) { iam_task_detail::wait_instance(h.promise().id, h.address(), instance_id); }
+	void await_resume() const noexcept {}
+};
+
+// co_await iam_wait_marker(instance, marker): resume when the instance crosses the marker
+struct iam_wait_marker {
+	ImGuiID instance_id;
+	ImGuiID marker_id;
+	iam_wait_marker(ImGuiID inst, ImGuiID marker) : instance_id(inst), marker_id(marker) {}
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(iam_task::handle_type h) { iam_task_detail::wait_marker(h.promise().id, h.address(), instance_id, marker_id); }
+	void await_resume() const noexcept {}
+};
+
+int iam_task_count();                                                            // Suspended tasks.
+#endif // IAM_HAS_COROUTINES
+
 // ----------------------------------------------------
 // iam_instance - playback control for a clip
 // ----------------------------------------------------
 class iam_instance {
 public:
-	iam_instance() : m_inst_id(0) {}
-	iam_instance(ImGuiID inst_id) : m_inst_id(inst_id) {}
+	iam_instance() : m_inst_id(0), m_handle(0) {}
+	iam_instance(ImGuiID inst_id) : m_inst_id(inst_id), m_handle(0) {}
+	iam_instance(ImGuiID inst_id, ImU32 handle) : m_inst_id(inst_id), m_handle(handle) {}  // handle: slot + generation (from iam_play/iam_get_instance)
 
 	// Playback control
 	void pause();
@@ -1007,17 +1129,33 @@ public:
 	void seek(float time);
 	void set_time_scale(float scale);
 	void set_weight(float weight);  // for layering/blending
+	void set_realtime(bool realtime);  // Evaluate on every iam_clip_update, ignoring iam_clip_set_tick_rate.
+	void set_priority(int priority);   // Evaluation order under iam_clip_set_update_budget (higher first, default 0).
+	void set_time_domain(ImGuiID domain_id);  // Move to a time domain (0 = default); set by iam_play from iam_push_time_domain.
+
+	// Visibility culling - hidden instances keep advancing time, markers and callbacks but only evaluate tracks
+	// when read or once visible again. Instanced lanes are not culled.
+	void set_visible(bool visible);                                                  // Manual hint (clears set_cull_rect).
+	void set_cull_rect(ImVec2 min, ImVec2 max);                                      // Call each frame from the widget it animates: culled while the rect is clipped or the call stops.
 
 	// Animation chaining - play another clip when this one completes
 	iam_instance& then(ImGuiID next_clip_id);                                        // Chain another clip to play after this one.
 	iam_instance& then(ImGuiID next_clip_id, ImGuiID next_instance_id);              // Chain with specific instance ID.
 	iam_instance& then_delay(float delay);                                           // Set delay before chained clip starts.
+#ifdef IAM_HAS_COROUTINES
+	iam_await_instance completed() const { return iam_await_instance(m_inst_id); }  // co_await: resume once playback stops.
+#endif
+
+	// Playlists (iam_play_playlist) - seek() takes playlist time on playlist instances
+	int playlist_index() const;                                                      // Current entry (-1 if not playing a playlist).
+	float playlist_time() const;                                                     // Time since the start of the playlist.
 
 	// Query state
 	float time() const;
 	float duration() const;
 	bool is_playing() const;
 	bool is_paused() const;
+	bool is_pending() const;                                                         // Waiting for its clip to stream in.
 
 	// Get animated values
 	bool get_float(ImGuiID channel, float* out) const;
@@ -1025,6 +1163,11 @@ public:
 	bool get_vec4(ImGuiID channel, ImVec4* out) const;
 	bool get_int(ImGuiID channel, int* out) const;
 	bool get_color(ImGuiID channel, ImVec4* out, int color_space = iam_col_oklab) const;  // Color blended in specified color space.
+	int get_all(void* out_struct, iam_channel_binding const* bindings, int count) const;  // Fill a user struct in one pass; returns channels written.
+
+	// Instanced playback (iam_play_instanced) - per-lane values as contiguous arrays of lane_count() floats
+	int lane_count() const;                                                          // Number of lanes (0 for regular instances).
+	float const* get_lanes(ImGuiID channel, int type, int component = 0) const;      // One component for all lanes; nullptr if absent. Relative tracks are unresolved (percent, then px_bias components).
 
 	// Check validity
 	bool valid() const;
@@ -1034,6 +1177,7 @@ public:
 
 private:
 	ImGuiID m_inst_id;
+	ImU32	m_handle;	// Slot index + generation for O(1) lookup; stale handles fall back to the id map
 };
 
 // ----------------------------------------------------
@@ -1047,19 +1191,126 @@ void iam_clip_shutdown();
 // Per-frame update (call after iam_update_begin_frame)
 void iam_clip_update(float dt);
 
+// Multi-threaded update - iam_clip_update advances/evaluates instance ranges through a user parallel-for,
+// then fires callbacks, markers and chains serially in instance order. The hook must call job(begin, end, job_user)
+// over [0, count) in chunks of about 'grain' instances and return once all chunks are done.
+// Variation callbacks (iam_var_callback) may run on worker threads when a hook is set.
+typedef void (*iam_clip_job_fn)(int begin, int end, void* job_user);
+typedef void (*iam_parallel_for_fn)(int count, int grain, iam_clip_job_fn job, void* job_user, void* user);
+void iam_clip_set_parallel_for(iam_parallel_for_fn fn, void* user = nullptr, int grain = 512);  // nullptr restores single-threaded update.
+
+// Event queue - iam_clip_update records begin, marker, loop, complete and chain events into a ring buffer that can
+// be drained in batches instead of (or alongside) callbacks. Markers without a callback are queued too.
+// One producer (iam_clip_update) and one consumer: iam_poll_events may run on another thread.
+enum iam_event_type {
+	iam_event_begin = 0,		// Instance started advancing (after any delay)
+	iam_event_marker,			// Marker crossed (marker_id, time = marker time)
+	iam_event_loop,				// Instance wrapped into a new loop iteration (loop = new iteration)
+	iam_event_complete,			// Instance finished
+	iam_event_chain				// Chained clip started (chained_id = instance playing it)
+};
+
+struct iam_event {
+	int type;                   // iam_event_type
+	ImGuiID instance_id;
+	ImGuiID clip_id;
+	ImGuiID marker_id;
+	ImGuiID chained_id;
+	float time;                 // Instance time (marker time for markers)
+	int loop;                   // Loop iteration of the instance
+};
+
+void iam_clip_set_event_queue(int capacity);                                    // Enable with room for capacity events (rounded up to a power of 2), 0 disables (default).
+int iam_poll_events(iam_event* out, int max_events);                            // Pop up to max_events, oldest first. Returns the count.
+unsigned iam_clip_events_dropped();                                             // Events lost because the queue was full.
+
 // Garbage collection for instances
 void iam_clip_gc(unsigned int max_age_frames = 600);
 
 // Play a clip on an instance (creates or reuses instance)
 iam_instance iam_play(ImGuiID clip_id, ImGuiID instance_id);
 
+// Instanced playback - one instance drives lane_count copies of the clip, lane i delayed by i * stagger.
+// Lanes are evaluated together and read through iam_instance::get_lanes; get_* return lane 0.
+iam_instance iam_play_instanced(ImGuiID clip_id, ImGuiID instance_id, int lane_count, float stagger);
+
+// Playlists - play clips back to back in one instance slot. Time left over at the end of an entry carries
+// into the next one in the same update (no gap frame, no new instance); seek() finds the entry in O(log N).
+// Each entry plays one pass of its clip after the clip's delay; loop settings are ignored. Member clips must be
+// registered (a missing one ends the playlist). Entry changes fire the clips' on_complete/on_begin callbacks.
+iam_result iam_playlist_create(ImGuiID playlist_id, ImGuiID const* clip_ids, int count);  // Define or replace a playlist.
+void iam_playlist_destroy(ImGuiID playlist_id);                                 // Playing instances stop at the end of their current entry.
+float iam_playlist_duration(ImGuiID playlist_id);                               // Sum of entry delays and durations (0 if unknown).
+iam_instance iam_play_playlist(ImGuiID playlist_id, ImGuiID instance_id);      // Play from the first entry (creates or reuses instance).
+
 // Get an existing instance (returns invalid iam_instance if not found)
 iam_instance iam_get_instance(ImGuiID instance_id);
 
+// Lazy evaluation - iam_clip_update only advances time, markers and callbacks; tracks are evaluated when read
+void iam_clip_set_lazy_eval(bool enable);                                       // Enable/disable on-demand track evaluation (off by default).
+bool iam_clip_get_lazy_eval();                                                  // Check if lazy evaluation is enabled.
+void iam_clip_get_eval_stats(int* out_evaluated, int* out_skipped);             // Tracks evaluated/skipped since the last iam_clip_update.
+int iam_clip_get_culled_count();                                                // Instances culled by the last iam_clip_update (see iam_instance::set_visible).
+
+// Shared evaluation cache - instances of a clip (without variations) at the same time reuse one evaluated block.
+// time_quantum > 0 snaps evaluation time to that step so near-lockstep instances share too.
+void iam_clip_set_eval_cache(bool enable, float time_quantum = 0.0f);          // Enable/disable the cache (off by default).
+void iam_clip_get_eval_cache_stats(int* out_hits, int* out_misses);             // Cache hits/misses since the last iam_clip_update.
+
+// Fixed tick rate - iam_clip_update still advances time, markers and callbacks every call, but evaluates tracks
+// only hz times per second; get_* interpolate between the last two ticks (reads trail by up to one tick).
+// Completion is always evaluated exactly. Instanced lanes and iam_instance::set_realtime instances are not ticked.
+void iam_clip_set_tick_rate(float hz);                                          // 0 = evaluate on every update (default).
+float iam_clip_get_tick_rate();                                                 // Current tick rate (0 = off).
+
+// Update budget - iam_clip_update advances every instance, then evaluates tracks in iam_instance::set_priority
+// order until the budget is spent. Deferred instances keep their previous values and gain one priority step per
+// update they wait; when their turn comes they evaluate at their current time. Events fire after evaluation.
+struct iam_clip_budget_stats {
+	int evaluated;              // Instances evaluated by the last update
+	int deferred;               // Instances left for later updates
+	int max_wait;               // Longest wait among them, in updates
+	float used_us;              // Time spent evaluating in the last update
+	float overrun_us;           // Time past the budget in the last update (0 = within budget)
+	unsigned overrun_updates;   // Updates over budget since enabled
+	unsigned deferred_updates;  // Updates that deferred work since enabled
+};
+void iam_clip_set_update_budget(float microseconds);                            // 0 = evaluate everything each update (default).
+float iam_clip_get_update_budget();                                             // Current budget in microseconds (0 = off).
+void iam_clip_get_budget_stats(iam_clip_budget_stats* out_stats);               // Scheduler statistics.
+
 // Query clip info
 float iam_clip_duration(ImGuiID clip_id);                                       // Get clip duration in seconds.
 bool iam_clip_exists(ImGuiID clip_id);                                          // Check if clip exists.
 
+// Baking - pre-sample tracks into uniform tables (eases, springs and beziers applied); playback becomes index + lerp.
+// Relative tracks and tracks with variations keep live evaluation. Rebuilding the clip drops the bake.
+iam_result iam_clip_bake(ImGuiID clip_id, float sample_rate);                   // Bake at sample_rate samples/sec (<= 0 removes the bake).
+bool iam_clip_get_bake_info(ImGuiID clip_id, int* out_bytes, float* out_max_error); // Memory and max error vs live evaluation; false if not baked.
+
+// Keyframe reduction - merge runs of keys (e.g. densely sampled imports) into single segments refit with a standard ease,
+// keeping the curve within tolerance (value units). Spring, variation and int tracks are left untouched.
+iam_result iam_clip_optimize(ImGuiID clip_id, float tolerance, int* out_keys_before = nullptr, int* out_keys_after = nullptr);
+
+// In-place key editing (timeline editors) - keys are addressed by (channel, iam_channel_type, index in time order).
+// Tracks stay sorted and keep their value slots, so playing instances keep their time and bindings; duration and
+// bakes are updated for the edited track only. value holds the track's floats (1/2/4/8 per type, ints as float).
+iam_result iam_clip_insert_key(ImGuiID clip_id, ImGuiID channel, int type, float time, float const* value, int ease_type = iam_ease_linear, int* out_index = nullptr);
+iam_result iam_clip_edit_key(ImGuiID clip_id, ImGuiID channel, int type, int key_index, float time, float const* value, int* out_index = nullptr);  // value may be nullptr (move only); out_index = index after re-sorting.
+iam_result iam_clip_remove_key(ImGuiID clip_id, ImGuiID channel, int type, int key_index);
+iam_result iam_clip_set_track_ease(ImGuiID clip_id, ImGuiID channel, int type, int key_index, int ease_type, float const* bezier4 = nullptr);  // key_index -1 = every key.
+int iam_clip_get_key_count(ImGuiID clip_id, ImGuiID channel, int type);
+bool iam_clip_get_key(ImGuiID clip_id, ImGuiID channel, int type, int key_index, float* out_time, float* out_value);
+
+// Stateless sampling (scrubbing, thumbnails) - evaluate a clip at clip-local times without an instance, markers or callbacks.
+// Output is one block of iam_clip_sample_size() floats per time; a channel's floats start at iam_clip_sample_offset().
+// Ints are written as float; relative channels hold (percent, px_bias) unresolved. Variations use loop_index and a fixed seed.
+// Safe to call from worker threads once the clip is registered (and activated, for packs) and not being edited.
+int iam_clip_sample_size(ImGuiID clip_id);                                      // Floats per sample (0 if the clip does not exist).
+int iam_clip_sample_offset(ImGuiID clip_id, ImGuiID channel, int type);         // Offset of a channel in a sample, -1 if absent.
+bool iam_clip_sample(ImGuiID clip_id, float time, int loop_index, float* out_values);
+bool iam_clip_sample_batch(ImGuiID clip_id, float const* times, int count, int loop_index, float* out_values);  // count samples, back to back.
+
 // Stagger helpers - compute delay for indexed instances
 float iam_stagger_delay(ImGuiID clip_id, int index);                            // Get stagger delay for element at index.
 iam_instance iam_play_stagger(ImGuiID clip_id, ImGuiID instance_id, int index); // Play with stagger delay applied.
@@ -1073,10 +1324,132 @@ bool iam_get_blended_vec2(ImGuiID instance_id, ImGuiID channel, ImVec2* out);
 bool iam_get_blended_vec4(ImGuiID instance_id, ImGuiID channel, ImVec4* out);   // Get blended vec4 value.
 bool iam_get_blended_int(ImGuiID instance_id, ImGuiID channel, int* out);       // Get blended int value.
 
+// Blend graphs - persistent layering: build once, evaluated for every iam_clip_update.
+// Nodes are returned as indices; a node's inputs must be created before it, the last node is the output.
+// Channels are bound to value slots when the graph is built (and again if a source changes clip);
+// colors blend in their track's color space, hue taking the short way around.
+void iam_blend_graph_begin(ImGuiID graph_id);                                   // Create or rebuild a graph in place.
+int iam_blend_graph_source(ImGuiID instance_id, float weight = 1.0f);           // Node reading an instance's values.
+int iam_blend_graph_blend(int const* inputs, int count, float weight = 1.0f);   // Weighted average of inputs (by their weights).
+int iam_blend_graph_additive(int base, int layer, float weight = 1.0f);         // base + layer * layer weight.
+int iam_blend_graph_override(int base, int layer, ImGuiID const* channels, int channel_count, float weight = 1.0f);  // Layer over base on masked channels (null = all).
+void iam_blend_graph_end();                                                     // Bind channels and evaluate once.
+void iam_blend_graph_set_weight(ImGuiID graph_id, int node, float weight);      // Change a node weight (no rebuild).
+void iam_blend_graph_evaluate(ImGuiID graph_id);                                // Re-evaluate now (e.g. after changing weights).
+void iam_blend_graph_destroy(ImGuiID graph_id);                                 // Free a graph.
+bool iam_blend_graph_get_float(ImGuiID graph_id, ImGuiID channel, float* out);  // Graph output; false if no source has it.
+bool iam_blend_graph_get_vec2(ImGuiID graph_id, ImGuiID channel, ImVec2* out);  // Graph vec2 output.
+bool iam_blend_graph_get_vec4(ImGuiID graph_id, ImGuiID channel, ImVec4* out);  // Graph vec4 output.
+bool iam_blend_graph_get_color(ImGuiID graph_id, ImGuiID channel, ImVec4* out); // Graph color output (sRGB).
+bool iam_blend_graph_get_int(ImGuiID graph_id, ImGuiID channel, int* out);      // Graph int output (rounded).
+
+// State machines - states bound to clips and transitions guarded by parameter conditions, with crossfades.
+// A machine is shared by any number of players (one per widget). A player's transitions are evaluated only when
+// one of its parameters changes, a trigger is fired or its state's clip completes; first matching transition wins.
+// During a crossfade both states' instances play and reads blend them by their instance weights.
+enum iam_sm_condition {
+	iam_sm_eq,          // param == value
+	iam_sm_ne,          // param != value
+	iam_sm_gt,          // param > value
+	iam_sm_lt,          // param < value
+	iam_sm_ge,          // param >= value
+	iam_sm_le,          // param <= value
+	iam_sm_trigger,     // param fired by iam_state_machine_trigger (consumed by the transition)
+	iam_sm_complete     // The current state's clip completed (param ignored)
+};
+void iam_state_machine_begin(ImGuiID machine_id);                               // Create or rebuild a machine in place.
+void iam_state_machine_state(ImGuiID state_id, ImGuiID clip_id);                // Add a state; the first one is the entry state.
+void iam_state_machine_transition(ImGuiID from_state, ImGuiID to_state, ImGuiID param, int condition, float value = 0.0f, float crossfade = 0.15f);  // from_state 0 = any state.
+void iam_state_machine_condition(ImGuiID param, int condition, float value = 0.0f);  // Extra condition (AND) on the last transition.
+void iam_state_machine_end();                                                   // Resolve state references.
+void iam_state_machine_destroy(ImGuiID machine_id);                             // Free a machine (players keep their instances).
+iam_result iam_state_machine_play(ImGuiID machine_id, ImGuiID player_id);       // Create a player in the entry state; cheap no-op if it already runs this machine.
+void iam_state_machine_set_param(ImGuiID player_id, ImGuiID param, float value);  // Re-evaluates transitions only if the value changed (params start at 0).
+void iam_state_machine_set_bool(ImGuiID player_id, ImGuiID param, bool value);  // Same as set_param with 0/1.
+void iam_state_machine_trigger(ImGuiID player_id, ImGuiID param);               // Fire a trigger now; dropped if no transition takes it.
+ImGuiID iam_state_machine_get_state(ImGuiID player_id);                         // Current state (0 if no such player).
+void iam_state_machine_stop(ImGuiID player_id);                                 // Destroy a player and its instances.
+bool iam_state_machine_get_float(ImGuiID player_id, ImGuiID channel, float* out);
+bool iam_state_machine_get_vec2(ImGuiID player_id, ImGuiID channel, ImVec2* out);
+bool iam_state_machine_get_vec4(ImGuiID player_id, ImGuiID channel, ImVec4* out);
+bool iam_state_machine_get_color(ImGuiID player_id, ImGuiID channel, ImVec4* out, int color_space = iam_col_oklab);  // Crossfades in color_space.
+bool iam_state_machine_get_int(ImGuiID player_id, ImGuiID channel, int* out);
+
 // Persistence (optional)
 iam_result iam_clip_save(ImGuiID clip_id, char const* path);
 iam_result iam_clip_load(char const* path, ImGuiID* out_clip_id);
 
+// Snapshots - the whole live animation state in one versioned, relocatable blob (hot reload, repeatable captures):
+// global time, time domains, tween channels (float/vec2/vec4/int/color/transform), oscillator/shake/wiggle/noise
+// state, scroll animations and clip instances (time, loops, markers, chaining, variation cache and RNG state).
+// Loading replaces that state; clips, playlists and state machines must already be registered, and instances of
+// clips that are not are dropped. Gradient tweens, blend graphs and coroutine tasks are not captured.
+size_t iam_snapshot_size();                                                                     // Bytes iam_snapshot_save needs for the current state.
+iam_result iam_snapshot_save(void* buffer, size_t capacity, size_t* out_size = nullptr);       // iam_err_no_mem if capacity is too small (out_size = bytes needed).
+iam_result iam_snapshot_load(void const* data, size_t size);                                   // iam_err_bad_arg on a corrupt blob or one from another layout.
+
+// Clip packs - many clips in one versioned, checksummed file laid out to be used in place (no per-clip parsing).
+// Clips are activated lazily the first time their id is used; packed tracks are evaluated straight from pack memory.
+// Editing, baking, optimizing or closing the pack copies a clip's keys out first.
+iam_result iam_clip_pack_save(char const* path, ImGuiID const* clip_ids, int count);           // Write clips into one pack file.
+iam_result iam_clip_pack_open(void const* data, size_t size, ImGuiID* out_pack_id = nullptr);  // Use caller memory (4-byte aligned, kept alive until close).
+iam_result iam_clip_pack_open_file(char const* path, ImGuiID* out_pack_id = nullptr);          // Memory-map a pack file (single read where mapping is unavailable).
+void iam_clip_pack_close(ImGuiID pack_id);                                                     // Close a pack; clips already activated stay registered.
+
+// Streaming clip library - register where clips live; each loads on its first iam_play and least recently played
+// clips are evicted when resident memory exceeds the budget (clips used by any instance are never evicted).
+// With an async hook, iam_play returns a pending instance that starts in the iam_clip_update after its data arrives.
+typedef void (*iam_clip_task_fn)(void* task_data);
+typedef void (*iam_clip_submit_fn)(iam_clip_task_fn task, void* task_data, void* user);        // Run task(task_data) on any thread.
+iam_result iam_clip_library_add_pack(char const* path);                                        // Index a pack file (reads header and index only).
+iam_result iam_clip_library_add_file(ImGuiID clip_id, char const* path);                       // Register a single-clip file (iam_clip_save format).
+iam_result iam_clip_library_add_dir(char const* dir, int* out_count = nullptr);                // Register every *.ianim clip file in a directory.
+void iam_clip_library_set_budget(size_t max_bytes);                                            // Resident memory budget (0 = unlimited).
+void iam_clip_library_set_async(iam_clip_submit_fn fn, void* user = nullptr);                  // Load on worker threads (nullptr = load inside iam_play).
+void iam_clip_library_get_stats(size_t* out_resident_bytes, int* out_resident, int* out_loading);
+
+// Static clips - clip tables compiled into the binary, registered in place (no copying, sorting or parsing).
+// iam_clip_export_cpp writes them as a header from registered clips (load a saved clip with iam_clip_load first).
+// Key data uses the pack layout: values hold 1 (float/int), 2 (vec2, float_rel), 4 (vec4, color, vec2_rel)
+// or 8 (vec4_rel, color_rel) floats per key; params hold 4 floats per key. Variations and callbacks are not stored.
+struct iam_static_track {
+	ImGuiID channel;
+	int type;                   // iam_channel_type
+	int color_space;            // iam_color_space (color tracks)
+	int is_relative;
+	int anchor_space;
+	int anchor_axis;
+	int key_count;
+	float const* times;         // Ascending
+	float const* values;
+	int const* eases;           // iam_ease_type per key
+	int const* flags;           // 1 = params are a cubic bezier, 2 = params are spring mass/stiffness/damping/velocity
+	float const* params;
+};
+
+struct iam_static_marker {
+	float time;                 // Ascending
+	ImGuiID marker_id;
+};
+
+struct iam_static_clip {
+	ImGuiID id;
+	float duration;
+	float delay;
+	int loop_count;
+	int direction;              // iam_direction
+	int stagger_count;
+	float stagger_delay;
+	float stagger_center_bias;
+	iam_static_track const* tracks;
+	int track_count;
+	iam_static_marker const* markers;
+	int marker_count;
+};
+
+iam_result iam_clip_register_static(iam_static_clip const* clips, int count);                 // Tables must outlive the clip system.
+iam_result iam_clip_export_cpp(char const* path, char const* symbol, ImGuiID const* clip_ids, int count);  // Emit <symbol>[] and <symbol>_count.
+
 // ----------------------------------------------------
 // Usage notes (summary)
 // ----------------------------------------------------